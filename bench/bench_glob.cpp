@@ -0,0 +1,128 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Benchmark of Glob params expansion.
+ *
+ *   bench_glob <dir> [files] [dirs]
+ *
+ * Fills <dir> with <files> empty .gz files (1000000 by default) spread
+ * in <dirs> sub-directories (1000 by default), unless it exists already,
+ * then times the expansion of a few patterns with QtConcurrent's thread
+ * pool using one thread, then every core. <dir> is not removed.
+ */
+
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QStringList>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QTime>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "qcommandlinecore.h"
+
+class CountHandler : public QCommandLineHandler
+{
+public:
+  CountHandler()
+    : count(0)
+  {
+  }
+
+  void paramFound(int, const QString &, const QString &)
+  {
+    count++;
+  }
+
+  int count;
+};
+
+static bool
+populate(const QString & root, int files, int dirs)
+{
+  QDir dir;
+
+  if (dir.exists(root))
+    return true;
+
+  printf("creating %d files in %d directories below %s\n", files, dirs, qPrintable(root));
+  for (int i = 0; i < dirs; ++i)
+    if (!dir.mkpath(root + QString(QLatin1String("/d%1")).arg(i)))
+      return false;
+
+  for (int i = 0; i < files; ++i) {
+    QFile file(root + QString(QLatin1String("/d%1/f%2.gz")).arg(i % dirs).arg(i));
+
+    if (!file.open(QIODevice::WriteOnly))
+      return false;
+  }
+  return true;
+}
+
+static void
+run(const QString & pattern, int threads)
+{
+  QCommandLineCore cmdline;
+  CountHandler handler;
+  QTime time;
+  int elapsed;
+
+  cmdline.addParam(QLatin1String("files"), QString(),
+		   QCommandLineCore::Flags(QCommandLineCore::Multiple | QCommandLineCore::Glob));
+  QThreadPool::globalInstance()->setMaxThreadCount(threads);
+
+  time.start();
+  cmdline.parse(QStringList() << QLatin1String("bench_glob") << pattern, handler);
+  elapsed = time.elapsed();
+
+  printf("%-40s %2d thread(s) %8d matches %8d ms\n",
+	 qPrintable(pattern), threads, handler.count, elapsed);
+}
+
+int
+main(int argc, char *argv[])
+{
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <dir> [files] [dirs]\n", argv[0]);
+    return 1;
+  }
+
+  QString root = QDir(QString::fromLocal8Bit(argv[1])).absolutePath();
+  int files = argc > 2 ? atoi(argv[2]) : 1000000;
+  int dirs = argc > 3 ? atoi(argv[3]) : 1000;
+  QStringList patterns;
+
+  if (files <= 0 || dirs <= 0 || !populate(root, files, dirs)) {
+    fprintf(stderr, "can't fill %s\n", argv[1]);
+    return 1;
+  }
+
+  patterns << root + QLatin1String("/d0/*.gz")
+	   << root + QLatin1String("/*/*.gz")
+	   << root + QLatin1String("/**/*.gz");
+
+  foreach (const QString & pattern, patterns) {
+    run(pattern, 1);
+    run(pattern, QThread::idealThreadCount());
+  }
+  return 0;
+}
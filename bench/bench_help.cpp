@@ -0,0 +1,99 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Benchmark of the help message.
+ *
+ *   bench_help [options] [width]
+ *
+ * Defines <options> options (2000 by default) with long descriptions,
+ * in sections of 100, then times building the help message wrapped to
+ * <width> columns (80 by default) the first time, once the layout is
+ * cached, and written to a stream instead of a string.
+ */
+
+#include <QtCore/QFile>
+#include <QtCore/QString>
+#include <QtCore/QTextStream>
+#include <QtCore/QTime>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "qcommandlinecore.h"
+
+static void
+report(const char *what, int elapsed, int size)
+{
+  printf("%-30s %8d ms %10d chars\n", what, elapsed, size);
+}
+
+int
+main(int argc, char *argv[])
+{
+  int options = argc > 1 ? atoi(argv[1]) : 2000;
+  int width = argc > 2 ? atoi(argv[2]) : 80;
+  QCommandLineCore cmdline;
+  QString descr;
+  QTime time;
+  int elapsed;
+
+  if (options <= 0 || width <= 0) {
+    fprintf(stderr, "usage: %s [options] [width]\n", argv[0]);
+    return 1;
+  }
+
+  for (int i = 0; i < 8; ++i)
+    descr += QLatin1String("Some rather long description of what this option does. ");
+
+  cmdline.setArguments(QStringList() << QLatin1String("bench_help"));
+  cmdline.setHelpWidth(width);
+  for (int i = 0; i < options; ++i) {
+    if (i % 100 == 0)
+      cmdline.addSection(QString(QLatin1String("Section %1")).arg(i / 100));
+    /* Distinct short names, not to drown the timings in warnings */
+    cmdline.addOption(QChar(ushort(0x4e00 + i)), QString(QLatin1String("option-%1")).arg(i), descr);
+  }
+
+  time.start();
+  QString first = cmdline.help();
+  elapsed = time.elapsed();
+  report("first help()", elapsed, first.size());
+
+  time.start();
+  QString cached = cmdline.help();
+  elapsed = time.elapsed();
+  report("cached help()", elapsed, cached.size());
+
+  QFile null(QLatin1String("/dev/null"));
+
+  if (!null.open(QIODevice::WriteOnly)) {
+    fprintf(stderr, "can't open /dev/null\n");
+    return 1;
+  }
+
+  QTextStream out(&null);
+
+  time.start();
+  cmdline.writeHelp(out);
+  out.flush();
+  elapsed = time.elapsed();
+  report("writeHelp() to /dev/null", elapsed, cached.size());
+  return 0;
+}
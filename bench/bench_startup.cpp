@@ -0,0 +1,104 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Startup time and binary size of a minimal helper reading three flags,
+ * built with QCommandLineCore (startup_core) and with the QCommandLine
+ * QObject wrapper (startup_qobject).
+ *
+ *   bench_startup [runs]
+ *
+ * Runs each helper <runs> times (200 by default) with "-v -j 4 -o out",
+ * and prints the mean wall time of a run. Sizes are those of the helper
+ * and of the qcommandline libraries it loads, when built shared.
+ */
+
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#include <QtCore/QProcess>
+#include <QtCore/QStringList>
+#include <QtCore/QTime>
+#include <stdio.h>
+#include <stdlib.h>
+
+static qint64
+fileSize(const QString & path)
+{
+  QFileInfo info(path);
+
+  return info.exists() ? info.size() : 0;
+}
+
+/* Size of a library built in LIBRARY_OUTPUT_PATH, 0 when linked statically */
+static qint64
+librarySize(const char *name)
+{
+  QDir dir(QLatin1String(QCOMMANDLINE_LIBRARY_DIR));
+  QStringList found = dir.entryList(QStringList() << QLatin1String(name) + QLatin1String(".so.*"),
+				    QDir::Files | QDir::NoSymLinks);
+
+  return found.isEmpty() ? 0 : fileSize(dir.filePath(found.first()));
+}
+
+static bool
+run(const QString & dir, const char *helper, const QStringList & libraries, int runs)
+{
+  QString program = QDir(dir).filePath(QLatin1String(helper));
+  QStringList args;
+  qint64 size = fileSize(program);
+  qint64 libs = 0;
+  QTime time;
+
+  foreach (const QString & library, libraries)
+    libs += librarySize(library.toLatin1().constData());
+
+  args << QLatin1String("-v") << QLatin1String("-j") << QLatin1String("4")
+       << QLatin1String("-o") << QLatin1String("out");
+
+  time.start();
+  for (int i = 0; i < runs; ++i)
+    if (QProcess::execute(program, args) != 0) {
+      fprintf(stderr, "%s failed\n", qPrintable(program));
+      return false;
+    }
+
+  printf("%-16s %8.2f ms/run %10lld bytes + %10lld bytes of libraries\n",
+	 helper, double(time.elapsed()) / runs, (long long)size, (long long)libs);
+  return true;
+}
+
+int
+main(int argc, char *argv[])
+{
+  int runs = argc > 1 ? atoi(argv[1]) : 200;
+  QString dir = QFileInfo(QString::fromLocal8Bit(argv[0])).absolutePath();
+
+  if (runs <= 0) {
+    fprintf(stderr, "usage: %s [runs]\n", argv[0]);
+    return 1;
+  }
+
+  if (!run(dir, "startup_core", QStringList() << QLatin1String("libqcommandlinecore"), runs))
+    return 1;
+  if (!run(dir, "startup_qobject", QStringList() << QLatin1String("libqcommandlinecore")
+	   << QLatin1String("libqcommandline"), runs))
+    return 1;
+  return 0;
+}
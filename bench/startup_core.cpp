@@ -0,0 +1,82 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Minimal helper reading three flags with QCommandLineCore, run by
+ * bench_startup. Compare with startup_qobject.cpp.
+ */
+
+#include <QtCore/QStringList>
+#include <stdio.h>
+
+#include "qcommandlinecore.h"
+
+struct Settings
+{
+  Settings()
+    : verbose(false), jobs(1)
+  {
+  }
+
+  bool verbose;
+  int jobs;
+  QString output;
+};
+
+class SettingsHandler : public QCommandLineHandler
+{
+public:
+  SettingsHandler(Settings & settings)
+    : settings(settings)
+  {
+  }
+
+  void switchFound(int, const QString &)
+  {
+    settings.verbose = true;
+  }
+
+  void optionFound(int, const QString & name, const QString & value)
+  {
+    if (name == QLatin1String("jobs"))
+      settings.jobs = value.toInt();
+    else
+      settings.output = value;
+  }
+
+private:
+  Settings & settings;
+};
+
+int
+main(int argc, char *argv[])
+{
+  QCommandLineCore cmdline(argc, argv);
+  Settings settings;
+  SettingsHandler handler(settings);
+
+  cmdline.addSwitch(QLatin1Char('v'), QLatin1String("verbose"), QLatin1String("Verbose"));
+  cmdline.addOption(QLatin1Char('j'), QLatin1String("jobs"), QLatin1String("Jobs"));
+  cmdline.addOption(QLatin1Char('o'), QLatin1String("output"), QLatin1String("Output"));
+
+  if (!cmdline.parse(cmdline.arguments(), handler))
+    return 1;
+  return settings.jobs > 0 ? 0 : 1;
+}
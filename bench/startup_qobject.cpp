@@ -0,0 +1,82 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Minimal helper reading three flags with QCommandLine signals, run by
+ * bench_startup. Compare with startup_core.cpp.
+ */
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QObject>
+#include <QtCore/QVariant>
+
+#include "qcommandline.h"
+
+class Settings : public QObject
+{
+  Q_OBJECT
+
+public:
+  Settings()
+    : verbose(false), jobs(1)
+  {
+  }
+
+  bool verbose;
+  int jobs;
+  QString output;
+
+public slots:
+  void switchFound(const QString &)
+  {
+    verbose = true;
+  }
+
+  void optionFound(const QString & name, const QVariant & value)
+  {
+    if (name == QLatin1String("jobs"))
+      jobs = value.toInt();
+    else
+      output = value.toString();
+  }
+};
+
+int
+main(int argc, char *argv[])
+{
+  QCoreApplication app(argc, argv);
+  QCommandLine cmdline(app);
+  Settings settings;
+
+  QObject::connect(&cmdline, SIGNAL(switchFound(const QString &)),
+		   &settings, SLOT(switchFound(const QString &)));
+  QObject::connect(&cmdline, SIGNAL(optionFound(const QString &, const QVariant &)),
+		   &settings, SLOT(optionFound(const QString &, const QVariant &)));
+
+  cmdline.addSwitch(QLatin1Char('v'), QLatin1String("verbose"), QLatin1String("Verbose"));
+  cmdline.addOption(QLatin1Char('j'), QLatin1String("jobs"), QLatin1String("Jobs"));
+  cmdline.addOption(QLatin1Char('o'), QLatin1String("output"), QLatin1String("Output"));
+
+  if (!cmdline.parse())
+    return 1;
+  return settings.jobs > 0 ? 0 : 1;
+}
+
+#include "startup_qobject.moc"
@@ -4,6 +4,7 @@
 #  QCOMMANDLINE_FOUND - whether the qcommand library was found
 #  QCOMMANDLINE_LIBRARIES - the qcommandline library
 #  QCOMMANDLINE_INCLUDE_DIR - the include path of the qcommandline library
+#  QCOMMANDLINESERVER_LIBRARIES - the optional qcommandlineserver library
 #
 
 if (QCOMMANDLINE_INCLUDE_DIR AND QCOMMANDLINE_LIBRARIES)
@@ -28,6 +29,24 @@ else (QCOMMANDLINE_INCLUDE_DIR AND QCOMMANDLINE_LIBRARIES)
     ${LIB_INSTALL_DIR}
   )
 
+  find_library (QCOMMANDLINECORE_LIBRARIES
+    NAMES
+    qcommandlinecore
+    PATHS
+    ${QCOMMANDLINE_LIBRARY_DIRS}
+    ${LIB_INSTALL_DIR}
+  )
+  if (QCOMMANDLINECORE_LIBRARIES)
+    set (QCOMMANDLINE_LIBRARIES ${QCOMMANDLINE_LIBRARIES} ${QCOMMANDLINECORE_LIBRARIES})
+  endif (QCOMMANDLINECORE_LIBRARIES)
+
+  find_library (QCOMMANDLINESERVER_LIBRARIES
+    NAMES
+    qcommandlineserver
+    PATHS
+    ${QCOMMANDLINE_LIBRARY_DIRS}
+    ${LIB_INSTALL_DIR}
+  )
   find_path (QCOMMANDLINE_INCLUDE_DIR
     NAMES
     qcommandline.h
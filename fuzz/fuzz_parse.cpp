@@ -0,0 +1,206 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Fuzzer for QCommandLineCore::parse().
+ *
+ * Input is text: one entry per line, an empty line, then one argument
+ * per line (argv[0] is implied). An entry line is
+ * "<type> <flags> <shortName> <longName>" where type is one of s
+ * (switch), o (option) or p (param) and flags an hexadecimal digit,
+ * see corpus/ for examples. Malformed entry lines are ignored.
+ *
+ * Every input is also given to the original parse() loop (reference.cpp)
+ * and the two event sequences must be identical, unless the
+ * QCOMMANDLINE_FUZZ_DIFF environment variable is set to 0. The reference
+ * has no ids, they are checked against the configuration instead.
+ */
+
+#include <QtCore/QByteArray>
+#include <QtCore/QFile>
+#include <QtCore/QtGlobal>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "qcommandlinecore.h"
+#include "reference.h"
+
+static void
+quietMessages(QtMsgType type, const char *msg)
+{
+  if (type == QtFatalMsg) {
+    fprintf(stderr, "%s\n", msg);
+    abort();
+  }
+}
+
+static bool
+differential()
+{
+  static int enabled = -1;
+
+  if (enabled == -1)
+    enabled = qgetenv("QCOMMANDLINE_FUZZ_DIFF") != "0";
+  return enabled;
+}
+
+static void
+decode(const QByteArray & data, QCommandLineConfig & config, QStringList & args)
+{
+  QList < QByteArray > lines = data.split('\n');
+  int i = 0;
+
+  for (; i < lines.size() && !lines[i].isEmpty(); ++i) {
+    const QByteArray & line = lines[i];
+    QCommandLineConfigEntry entry;
+    bool ok;
+
+    if (line.size() < 6 || line[1] != ' ' || line[3] != ' ' || line[5] != ' ')
+      continue;
+
+    switch (line[0]) {
+    case 's':
+      entry.type = QCommandLineCore::Switch;
+      break;
+    case 'o':
+      entry.type = QCommandLineCore::Option;
+      break;
+    case 'p':
+      entry.type = QCommandLineCore::Param;
+      break;
+    default:
+      continue;
+    }
+
+    /* Only the flags known to the reference parser */
+    entry.flags = (QCommandLineCore::Flags) (line.mid(2, 1).toInt(&ok, 16) & 0x7);
+    if (!ok)
+      continue;
+    entry.shortName = QLatin1Char(line[4] == '_' ? '\0' : line[4]);
+    entry.longName = QString::fromUtf8(line.mid(6));
+    config << entry;
+  }
+
+  args << QLatin1String("fuzz");
+  for (++i; i < lines.size(); ++i)
+    args << QString::fromUtf8(lines[i]);
+}
+
+static QByteArray
+dump(const QCommandLineResult & result)
+{
+  QByteArray out;
+
+  foreach (const QCommandLineEvent & event, result.events) {
+    out += QByteArray::number(event.kind) + ' ' + QByteArray::number(event.id) + ' ';
+    out += event.name.toUtf8() + ' ' + event.value.toUtf8() + '\n';
+  }
+  return out;
+}
+
+/* Id an entry name must be reported with, see QCommandLineCore::entryId() */
+static int
+expectedId(const QCommandLineConfig & config, const QString & name)
+{
+  for (int i = 0; i < config.size(); ++i)
+    if (config[i].longName == name)
+      return i;
+  if (name == QCommandLineCore::helpEntry.longName)
+    return QCommandLineCore::HelpId;
+  if (name == QCommandLineCore::versionEntry.longName)
+    return QCommandLineCore::VersionId;
+  return QCommandLineCore::InvalidId;
+}
+
+static bool
+sameEvents(const QCommandLineResult & a, const QCommandLineResult & b)
+{
+  if (a.events.size() != b.events.size())
+    return false;
+  for (int i = 0; i < a.events.size(); ++i) {
+    if (a.events[i].kind != b.events[i].kind ||
+	a.events[i].name != b.events[i].name ||
+	a.events[i].value != b.events[i].value)
+      return false;
+  }
+  return true;
+}
+
+extern "C" int
+LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+  static bool init = false;
+  QCommandLineConfig config;
+  QStringList args;
+
+  if (!init) {
+    qInstallMsgHandler(quietMessages);
+    init = true;
+  }
+
+  decode(QByteArray((const char *) data, (int) size), config, args);
+
+  QCommandLineCore cmdline(args, config);
+  QCommandLineResult result;
+  bool ok = cmdline.parse(result);
+
+  if (differential()) {
+    QCommandLineResult expected;
+    bool expectedOk = referenceParse(config, args, true, true, expected);
+
+    if (ok != expectedOk || !sameEvents(result, expected)) {
+      fprintf(stderr, "parse() differs from the reference\n");
+      fprintf(stderr, "expected (%d):\n%s", expectedOk, dump(expected).constData());
+      fprintf(stderr, "got (%d):\n%s", ok, dump(result).constData());
+      abort();
+    }
+  }
+
+  foreach (const QCommandLineEvent & event, result.events) {
+    if (event.kind != QCommandLineEvent::Error &&
+	event.id != expectedId(config, event.name)) {
+      fprintf(stderr, "wrong id %d for %s\n", event.id, qPrintable(event.name));
+      abort();
+    }
+  }
+  return 0;
+}
+
+#ifdef QCOMMANDLINE_FUZZ_STANDALONE
+/* Without libFuzzer (AFL, replaying a corpus): run every file given */
+int
+main(int argc, char *argv[])
+{
+  for (int i = 1; i < argc; ++i) {
+    QFile file(QString::fromLocal8Bit(argv[i]));
+
+    if (!file.open(QIODevice::ReadOnly)) {
+      fprintf(stderr, "Can't open %s\n", argv[i]);
+      return 1;
+    }
+
+    QByteArray data = file.readAll();
+
+    LLVMFuzzerTestOneInput((const uint8_t *) data.constData(), data.size());
+  }
+  return 0;
+}
+#endif
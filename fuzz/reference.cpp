@@ -0,0 +1,217 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QMap>
+#include <QtCore/QQueue>
+#include <QDebug>
+
+#include "reference.h"
+
+static inline QString
+tr(const char *text)
+{
+  return QCoreApplication::translate("QCommandLine", text);
+}
+
+bool
+referenceParse(const QCommandLineConfig & config, QStringList args,
+	       bool help, bool version, QCommandLineHandler & handler)
+{
+  const QCommandLineConfigEntry & helpEntry = QCommandLineCore::helpEntry;
+  const QCommandLineConfigEntry & versionEntry = QCommandLineCore::versionEntry;
+  QMap < QString, QCommandLineConfigEntry > conf;
+  QMap < QString, QCommandLineConfigEntry > confLong;
+  QQueue < QCommandLineConfigEntry > params;
+  QMap < QString, QList < QString > > optionsFound;
+  QMap < QString, int > switchsFound;
+  QStringList options, switchs;
+
+  bool allparam = false;
+
+  foreach (QCommandLineConfigEntry entry, config) {
+    if (entry.type != QCommandLineCore::Param && entry.shortName == QLatin1Char('\0'))
+      qWarning() << QLatin1String("QCommandLine: Empty shortname detected");
+    if (entry.longName.isEmpty())
+      qWarning() << QLatin1String("QCommandLine: Empty shortname detected");
+    if (entry.type != QCommandLineCore::Param && conf.find(entry.shortName) != conf.end())
+      qWarning() << QLatin1String("QCommandLine: Duplicated shortname detected ") << entry.shortName;
+    if (conf.find(entry.longName) != conf.end())
+      qWarning() << QLatin1String("QCommandLine: Duplicated longname detected ") << entry.shortName;
+
+    if (entry.type == QCommandLineCore::Param)
+      params << entry;
+    else
+      conf[entry.shortName] = entry;
+    confLong[entry.longName] = entry;
+  }
+
+  if (help) {
+    conf[helpEntry.shortName] = helpEntry;
+    confLong[helpEntry.longName] = helpEntry;
+  }
+
+  if (version) {
+    conf[versionEntry.shortName] = versionEntry;
+    confLong[versionEntry.longName] = versionEntry;
+  }
+
+  for (int i = 1; i < args.size(); ++i) {
+    QString arg = args[i];
+    bool param = true, shrt = false, stay = false, forward = false;
+
+    /* A '+' was found, all remaining options are params */
+    if (allparam)
+      param = true;
+    else if (arg.startsWith(QLatin1String("--"))) {
+      param = false;
+      shrt = false;
+      arg = arg.mid(2);
+    } else if (arg.startsWith(QLatin1Char('-')) || arg.startsWith(QLatin1Char('+'))) {
+      if (arg.startsWith(QLatin1Char('+')))
+	allparam = true;
+      param = false;
+      shrt = true;
+      /* Handle stacked args like `tar -xzf` */
+      if (arg.size() > 2) {
+	args[i] = arg.mid(0, 2);
+	args.insert(i + 1, arg.mid(0, 1) + arg.mid(2));
+	arg = arg.mid(1, 1);
+      } else {
+	arg = arg.mid(1);
+      }
+    }
+
+    /* Handle params */
+    if (param) {
+      if (!params.size()) {
+	handler.parseError(tr("Unknown param: %1").arg(arg));
+	return false;
+      }
+
+      QCommandLineConfigEntry & entry = params.first();
+
+      if (entry.flags & QCommandLineCore::Mandatory) {
+	entry.flags = (QCommandLineCore::Flags) (entry.flags & ~QCommandLineCore::Mandatory);
+	entry.flags = (QCommandLineCore::Flags) (entry.flags | QCommandLineCore::Optional);
+      }
+
+      handler.paramFound(QCommandLineCore::InvalidId, entry.longName, arg);
+
+      if (!(entry.flags & QCommandLineCore::Multiple))
+	params.dequeue();
+
+    } else { /* Options and switchs* */
+      QString key;
+      QString value;
+      int idx = arg.indexOf(QLatin1Char('='));
+
+      if (idx != -1) {
+	key = arg.mid(0, idx);
+	value = arg.mid(idx + 1);
+      } else {
+	key = arg;
+      }
+
+      QMap < QString, QCommandLineConfigEntry > & c = shrt ? conf : confLong;
+
+      if (c.find(key) == c.end()) {
+	handler.parseError(tr("Unknown option: %1").arg(key));
+	return false;
+      }
+
+      QCommandLineConfigEntry & entry = c[key];
+
+      if (entry.type == QCommandLineCore::Switch) {
+	if (!switchsFound.contains(entry.longName))
+	  switchs << entry.longName;
+	if (entry.flags & QCommandLineCore::Multiple)
+	  switchsFound[entry.longName]++;
+	else
+	  switchsFound[entry.longName] = 1;
+      } else {
+	if (stay) {
+	  handler.parseError(tr("Option %1 need a value").arg(key));
+	  return false;
+	}
+
+	if (idx == -1) {
+	  if (i+1 < args.size() && !args[i+1].startsWith(QLatin1Char('-'))) {
+	    value = args[i+1];
+	    forward = true;
+	  } else {
+	    handler.parseError(tr("Option %1 need a value").arg(key));
+	    return false;
+	  }
+	}
+
+	if (!optionsFound.contains(entry.longName))
+	  options << entry.longName;
+	if (!(entry.flags & QCommandLineCore::Multiple))
+	  optionsFound[entry.longName].clear();
+	optionsFound[entry.longName].append(value);
+      }
+
+      if (entry.flags & QCommandLineCore::Mandatory) {
+	entry.flags = (QCommandLineCore::Flags) (entry.flags & ~QCommandLineCore::Mandatory);
+	entry.flags = (QCommandLineCore::Flags) (entry.flags | QCommandLineCore::Optional);
+	conf[entry.shortName] = entry;
+	confLong[entry.shortName] = entry;
+      }
+    }
+    /* Stay here, stacked args */
+    if (stay)
+      i--;
+    else if (forward)
+      i++;
+  }
+
+  foreach (QCommandLineConfigEntry entry, params) {
+    if (entry.flags & QCommandLineCore::Mandatory) {
+      handler.parseError(tr("Param %1 is mandatory").arg(entry.longName));
+      return false;
+    }
+  }
+
+  foreach (QCommandLineConfigEntry entry, conf.values()) {
+    if (entry.flags & QCommandLineCore::Mandatory) {
+      QString type;
+
+      if (entry.type == QCommandLineCore::Switch)
+	type = tr("Switch");
+      if (entry.type == QCommandLineCore::Option)
+	type = tr("Option");
+
+      handler.parseError(tr("%1 %2 is mandatory").arg(type).arg(entry.longName));
+      return false;
+    }
+  }
+
+  foreach (QString key, switchs) {
+    for (int i = 0; i < switchsFound[key]; i++)
+      handler.switchFound(QCommandLineCore::InvalidId, key);
+  }
+
+  foreach (QString key, options) {
+    foreach (QString opt, optionsFound[key])
+      handler.optionFound(QCommandLineCore::InvalidId, key, opt);
+  }
+  return true;
+}
@@ -0,0 +1,33 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef QCOMMAND_LINE_REFERENCE_H
+# define QCOMMAND_LINE_REFERENCE_H
+
+#include "qcommandlinecore.h"
+
+/*
+ * The original QCommandLine::parse() loop, kept untouched as the
+ * reference new parsers are compared against. It has no entry ids,
+ * InvalidId is reported instead.
+ */
+bool referenceParse(const QCommandLineConfig & config, QStringList args,
+		    bool help, bool version, QCommandLineHandler & handler);
+
+#endif
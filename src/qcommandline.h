@@ -24,6 +24,9 @@
 #include <QtCore/QList>
 #include <QtCore/QStringList>
 
+#include "qcommandlinecore.h"
+#include "qcommandlinerange.h"
+
 #ifndef QCOMMANDLINE_EXPORT
 # ifndef QCOMMANDLINE_STATIC
 #  if defined(QCOMMANDLINE_MAKEDLL)
@@ -40,53 +43,18 @@
 #endif
 
 class QCoreApplication;
-
-struct QCommandLineConfigEntry;
-typedef QList< QCommandLineConfigEntry > QCommandLineConfig;
-
-class QCommandLinePrivate {
-public:
-    bool version;
-    bool help;
-    QStringList args;
-    QCommandLineConfig config;
-};
-
-/**
- * Use this macro to mark the end of a QCommandLineConfigEntry array
- */
-#define QCOMMANDLINE_CONFIG_ENTRY_END      \
-    { QCommandLine::None, '\0', NULL, NULL, QCommandLine::Default }
+class QCommandLineSignalHandler;
 
 /**
  * @brief Main class used to convert parse command line
+ *
+ * Thin QObject wrapper around QCommandLineCore: the parsing is done
+ * by the core and results are emitted as signals.
  */
-class QCOMMANDLINE_EXPORT QCommandLine : public QObject
+class QCOMMANDLINE_EXPORT QCommandLine : public QObject, public QCommandLineCore
 {
   Q_OBJECT
 public:
-    /**
-     * Enum used to determine entry type in QCommandLineConfigEntry
-     */
-    typedef enum {
-	None = 0, /**< can be used for the last line of a QCommandLineConfigEntry[] . */
-	Switch, /**< a simple switch wihout argument (eg: ls -l) */
-	Option, /**< an option with an argument (eg: tar -f test.tar) */
-	Param /**< a parameter without '-' delimiter (eg: cp foo bar) */
-    } Type;
-
-    /**
-     * Flags that can be applied to a QCommandLineConfigEntry
-     */
-    typedef enum {
-	Default = 0, /**< can be used for the last line of a QCommandLineConfigEntry[] . */
-	Mandatory = 0x01, /**< mandatory argument, will produce a parse error if not present */
-	Optional = 0x02, /**< optional argument */
-	Multiple = 0x04, /**< argument can be used multiple time and will produce multiple signals. */
-	MandatoryMultiple = Mandatory|Multiple,
-	OptionalMultiple = Optional|Multiple,
-    } Flags;
-
     /**
      * QCommandLine constructor
      * QCoreApplication::instance()->arguments() will be called to get the arguments.
@@ -134,76 +102,7 @@ public:
      */
    ~QCommandLine();
 
-    /**
-     * Set the parser configuration
-     * @param config The configuration
-     * @sa config
-     */
-    void setConfig(const QCommandLineConfig & config);
-
-    /**
-     * Set the parser configuration
-     * @param config An array containing the configuration
-     * @sa config
-     */
-    void setConfig(const QCommandLineConfigEntry config[]);
-
-    /**
-     * Get the current parser configuration
-     * @returns The parser configuration
-     * @sa setConfig
-     */
-    QCommandLineConfig config();
-
-    /**
-     * Set command line arguments
-     * @param argc Size of the argv array
-     * @param argv Array of arguments
-     * @sa arguments
-     */
-    void setArguments(int argc, char *argv[]);
-
-    /**
-     * Set command line arguments
-     * @param args A list of arguments
-     * @sa arguments
-     */
-    void setArguments(const QStringList & args);
-
-    /**
-     * Get command line arguments
-     * @returns Command line arguments (like QApplication::arguments())
-     * @sa arguments
-     */
-    QStringList arguments() const;
-
-    /**
-     * Enable --help,-h switch
-     * @param enable true to enable, false to disable
-     * @sa enableHelp
-     */
-    void enableHelp(bool enable);
-
-    /**
-     * Check if help is enabled or not.
-     * @returns true if help is enabled; otherwise returns false.
-     * @sa enableVersion
-     */
-    bool helpEnabled() const;
-
-    /**
-     * Enable --version,-V switch
-     * @param enable true to enable, false to disable
-     * @sa versionEnabled
-     */
-    void enableVersion(bool enable);
-
-    /**
-     * Check if version is enabled or not.
-     * @returns true if version is enabled; otherwise returns false.
-     * @sa enableHelp
-     */
-    bool versionEnabled() const;
+    using QCommandLineCore::parse;
 
     /**
      * Parse command line and emmit signals when switchs, options, or
@@ -214,125 +113,66 @@ public:
     bool parse();
 
     /**
-     * Define a new option
-     * @param shortName Short name for this option (ex: h)
-     * @param longName Long name for this option (ex: help)
-     * @param descr Help text
-     * @param flags Switch flags
-     * @sa addSwitch
-     * @sa addParam
-     */
-    void addOption(const QChar & shortName,
-		   const QString & longName = QString(),
-		   const QString & descr = QString(),
-		   QCommandLine::Flags flags = QCommandLine::Optional);
-
-    /**
-     * Define a new switch
-     * @param shortName Short name for this switch (ex: h)
-     * @param longName Long name for this switch (ex: help)
-     * @param descr Help text
-     * @param flags Parameter flags
-     * @sa addOption
-     * @sa addParam
+     * Parse @p args against the current configuration, for a program
+     * changing its settings while running.
+     *
+     * Only the switches and options whose values differ from the
+     * previous parse() or reparse() are emitted, with switchFound(),
+     * optionFound() or rangeFound(), in the order parse() reports them:
+     * switches, then options, then ranges. Those not given anymore are
+     * reported with entryCleared() first. A changed entry which was
+     * given before is cleared too, then every one of its occurrences is
+     * emitted again, so that a Multiple option or a counted switch can
+     * be rebuilt from scratch. Help and version are never shown.
+     *
+     * Params are not reported nor required, even Mandatory ones: a lone
+     * "-" does not read a Stream param, Glob params are not expanded
+     * and params are not checked on the filesystem. Options are checked
+     * as usual, and the result cache is not used.
+     *
+     * On error parseError() is emitted and nothing else changes.
+     * Otherwise @p args become the arguments of this parser.
+     * @param args Command line arguments, the first one being the program name
+     * @param error If not null, set to the error description
+     * @returns true if successfully parsed; otherwise returns false.
+     * @sa QCommandLineServer
      */
-    void addSwitch(const QChar & shortName,
-		   const QString & longName = QString(),
-		   const QString & descr = QString(),
-		   QCommandLine::Flags flags = QCommandLine::Optional);
+    bool reparse(const QStringList & args, QString *error = 0);
 
+signals:
     /**
-     * Define a new parameter
-     * @param name Name, used in help, usage and error messages
-     * @param descr Help text
-     * @param flags Parameter flags
+     * Signal emitted when a switch is found while parsing
+     * @param name The "longName" of the switch.
+     * @sa parse
      * @sa addSwitch
-     * @sa addOption
-     */
-    void addParam(const QString & name,
-		  const QString & descr = QString(),
-		  QCommandLine::Flags flags = QCommandLine::Optional);
-
-    /**
-     * Remove any option of type QCommandLine::Option with a given shortName or longName.
-     * @param name the name of the option to remove
-     * @sa removeParam
-     * @sa removeSwitch
-     */
-    void removeOption(const QString & name);
-
-    /**
-     * Remove any option of type QCommandLine::Switch with a given shortName or longName.
-     * @param name the name of the option to remove
-     * @sa removeOption
-     * @sa removeParam
-     */
-    void removeSwitch(const QString & name);
-
-    /**
-     * Remove any option of type QCommandLine::Param with a given shortName or longName.
-     * @param name the name of the option to remove
-     * @sa removeOption
-     * @sa removeSwitch
-     */
-    void removeParam(const QString & name);
-
-    /**
-     * Return the help message
-     * @param logo also show version message on top of the help message
-     * @sa version
-     */
-    QString help(bool logo = true);
-
-    /**
-     * Return the version message
-     * @sa help
      */
-    QString version();
-
-    /**
-     * Show the help message.
-     * @param exit Exit if true
-     * @param returnCode return code of the program if exit is true
-     * @sa showVersion
-     */
-    void showHelp(bool exit = true, int returnCode = 0);
-
-    /**
-     * Show the version message.
-     * @param exit Exit if true
-     * @param returnCode return code of the program if exit is true
-     * @sa showHelp
-     */
-    void showVersion(bool exit = true, int returnCode = 0);
-
-    /**
-     * Standard --help, -h entry
-     */
-    static const QCommandLineConfigEntry helpEntry;
+    void switchFound(const QString & name);
 
     /**
-     * Standard --version, -V entry
+     * Signal emitted when a switch is found while parsing
+     * @param id The id of the switch.
+     * @sa parse
+     * @sa entryId
      */
-    static const QCommandLineConfigEntry versionEntry;
+    void switchFound(int id);
 
-signals:
     /**
-     * Signal emitted when a switch is found while parsing
+     * Signal emitted when an option is found while parsing
      * @param name The "longName" of the switch.
+     * @param value The value of that option
      * @sa parse
      * @sa addSwitch
      */
-    void switchFound(const QString & name);
+    void optionFound(const QString & name, const QVariant & value);
 
     /**
      * Signal emitted when an option is found while parsing
-     * @param name The "longName" of the switch.
+     * @param id The id of the option.
      * @param value The value of that option
      * @sa parse
-     * @sa addSwitch
+     * @sa entryId
      */
-    void optionFound(const QString & name, const QVariant & value);
+    void optionFound(int id, const QVariant & value);
 
     /**
      * Signal emitted when a param is found while parsing
@@ -344,40 +184,64 @@ signals:
     void paramFound(const QString & name, const QVariant & value);
 
     /**
-     * Signal emitted when a parse error is detected
-     * @param error Parse error description
+     * Signal emitted when a param is found while parsing
+     * @param id The id of the param.
+     * @param value The actual argument
      * @sa parse
+     * @sa entryId
      */
-    void parseError(const QString & error);
-private:
-    QCommandLinePrivate *d;
-    Q_DECLARE_PRIVATE(QCommandLine);
-};
+    void paramFound(int id, const QVariant & value);
 
-/**
- * @brief Configuration entry structure
- */
-struct QCommandLineConfigEntry {
     /**
-     * Entry Type
+     * Signal emitted when a Range option is found while parsing, once
+     * with all the values given to it
+     * @param name The "longName" of the option.
+     * @param range The values of that option
+     * @sa parse
+     * @sa QCommandLineRange
      */
-    QCommandLine::Type type;
+    void rangeFound(const QString & name, const QCommandLineRange & range);
+
     /**
-     * Short Name
+     * Signal emitted when a Range option is found while parsing, once
+     * with all the values given to it
+     * @param id The id of the option.
+     * @param range The values of that option
+     * @sa parse
+     * @sa entryId
      */
-    QChar shortName;
+    void rangeFound(int id, const QCommandLineRange & range);
+
     /**
-     * Long Name
+     * Signal emitted when a parse error is detected
+     * @param error Parse error description
+     * @sa parse
      */
-    QString longName;
+    void parseError(const QString & error);
+
     /**
-     * Description, used in --help
+     * Signal emitted by reparse() when a switch or option given to the
+     * previous parse is not given anymore, or before its
+     * occurrences are emitted again
+     * @param name The "longName" of the entry.
+     * @sa reparse
      */
-    QString descr;
+    void entryCleared(const QString & name);
+
     /**
-     * Option flags
+     * Signal emitted by reparse() when a switch or option given to the
+     * previous parse is not given anymore, or before its
+     * occurrences are emitted again
+     * @param id The id of the entry.
+     * @sa reparse
+     * @sa entryId
      */
-    QCommandLine::Flags flags;
+    void entryCleared(int id);
+private:
+    friend class QCommandLineSignalHandler;
+
+    /* Switches and options found by the last parse, for reparse() */
+    QList< QCommandLineEvent > found;
 };
 
 #endif
@@ -0,0 +1,367 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSet>
+#include <QtCore/QTemporaryFile>
+
+#ifdef Q_OS_UNIX
+# include <sys/stat.h>
+# include <unistd.h>
+#endif
+
+#include "qcommandlinecache_p.h"
+#include "qcommandlinerange.h"
+
+static const quint32 cacheMagic = 0x51434c43; /* "QCLC" */
+static const quint32 cacheVersion = 3;
+
+/* Files kept in a cache directory, and for how long */
+static const int maxFiles = 256;
+static const int maxAge = 30 * 24 * 60 * 60;
+
+static const int pathChecks = QCommandLineValidator::Exists | QCommandLineValidator::File |
+  QCommandLineValidator::Dir | QCommandLineValidator::Readable;
+
+/* 64 bits FNV-1a */
+class QCommandLineHash {
+public:
+    QCommandLineHash() : value(Q_UINT64_C(0xcbf29ce484222325)) {}
+
+    void add(const void *data, int size)
+    {
+      const uchar *p = (const uchar *) data;
+
+      while (size-- > 0) {
+	value ^= *p++;
+	value *= Q_UINT64_C(0x100000001b3);
+      }
+    }
+
+    quint64 value;
+};
+
+/* State of a file a cached result depends on */
+struct QCommandLineCacheFile {
+    QString path;
+    bool exists;
+    qint64 size;
+    qint64 modified;
+    qint64 changed;
+    qint32 permissions;
+};
+
+static QCommandLineCacheFile
+fileState(const QString & path)
+{
+  QFileInfo info(path);
+  QCommandLineCacheFile file;
+
+  file.path = path;
+  file.exists = info.exists();
+  file.size = file.exists ? info.size() : 0;
+  file.modified = file.exists ? info.lastModified().toMSecsSinceEpoch() : 0;
+  /* The inode change time on Unix, it catches permission changes */
+  file.changed = file.exists ? info.created().toMSecsSinceEpoch() : 0;
+  file.permissions = file.exists ? (qint32) info.permissions() : 0;
+  return file;
+}
+
+static bool
+operator==(const QCommandLineCacheFile & a, const QCommandLineCacheFile & b)
+{
+  return a.exists == b.exists && a.size == b.size && a.modified == b.modified &&
+    a.changed == b.changed && a.permissions == b.permissions;
+}
+
+QCommandLineCache::QCommandLineCache(const QCommandLineSpec & spec, QCommandLineHandler & handler)
+  : spec(spec), handler(handler)
+{
+}
+
+QByteArray
+QCommandLineCache::key(const QCommandLineSpec & spec, const QCommandLineArguments & args)
+{
+  QByteArray key;
+  QDataStream out(&key, QIODevice::WriteOnly);
+
+  out.setVersion(QDataStream::Qt_4_6);
+
+  /* Slots include help and version, sections don't change results */
+  for (int i = 0; i < spec.entries.size(); ++i) {
+    const QCommandLineConfigEntry & entry = *spec.entries.at(i);
+    const QCommandLineValidator & validator = spec.validators.at(i);
+
+    /* Their results depend on more than the arguments */
+    if (entry.flags & (QCommandLineCore::Stream | QCommandLineCore::Glob))
+      return QByteArray();
+
+    out << (qint32) spec.nameIds.at(spec.names.at(i)) << (qint32) entry.type
+	<< entry.shortName << entry.longName << (qint32) entry.flags
+	<< (qint32) validator.checks << validator.pattern << validator.min << validator.max;
+  }
+
+  out << (qint32) args.count();
+  for (int i = 0; i < args.count(); ++i)
+    out << args.at(i);
+  return key;
+}
+
+QString
+QCommandLineCache::fileName(const QByteArray & key, const QString & dir)
+{
+  QCommandLineHash hash;
+
+  if (key.isEmpty() || dir.isEmpty())
+    return QString();
+
+  hash.add(key.constData(), key.size());
+  return QDir(dir).filePath(QString::number(hash.value, 16).rightJustified(16, QLatin1Char('0')) +
+				    QLatin1String(".qclc"));
+}
+
+/* Drop the files of dir older than maxAge, and the oldest beyond maxFiles */
+static void
+prune(const QString & dir)
+{
+  QFileInfoList files = QDir(dir).entryInfoList(QStringList() << QLatin1String("*.qclc"),
+						 QDir::Files, QDir::Time);
+  QDateTime oldest = QDateTime::currentDateTime().addSecs(-maxAge);
+
+  /* Newest first */
+  for (int i = 0; i < files.size(); ++i)
+    if (i >= maxFiles || files.at(i).lastModified() < oldest)
+      QFile::remove(files.at(i).filePath());
+}
+
+/* Only trust files nobody else could have written */
+static bool
+isPrivate(const QFile & file)
+{
+#ifdef Q_OS_UNIX
+  struct stat st;
+
+  if (fstat(file.handle(), &st) != 0)
+    return false;
+  return st.st_uid == geteuid() && !(st.st_mode & (S_IWGRP | S_IWOTH));
+#else
+  Q_UNUSED(file);
+  return true;
+#endif
+}
+
+/* Whether the option called name is a Range */
+static bool
+isRange(const QCommandLineSpec & spec, const QString & name)
+{
+  QHash< QString, QCommandLineKey >::const_iterator it = spec.longKeys.constFind(name);
+
+  return it != spec.longKeys.constEnd() &&
+    spec.entries.at(it.value().slot)->type == QCommandLineCore::Range;
+}
+
+bool
+QCommandLineCache::replay(const QCommandLineSpec & spec, const QString & fileName,
+			  const QByteArray & key, QCommandLineHandler & handler)
+{
+  QFile file(fileName);
+  QList< QCommandLineEvent > events;
+  quint32 magic, version, count;
+  QByteArray storedKey;
+  uchar *map;
+
+  if (!file.open(QIODevice::ReadOnly) || !isPrivate(file) || file.size() < 8)
+    return false;
+  if (!(map = file.map(0, file.size())))
+    return false;
+
+  /* Read in place, only the strings are copied */
+  QByteArray data = QByteArray::fromRawData((const char *) map, file.size());
+  QDataStream in(data);
+
+  in.setVersion(QDataStream::Qt_4_6);
+  in >> magic >> version;
+  if (magic != cacheMagic || version != cacheVersion)
+    return false;
+
+  /* The file name is only a hash: check this is the same configuration and arguments */
+  in >> storedKey;
+  if (in.status() != QDataStream::Ok || storedKey != key)
+    return false;
+
+  in >> count;
+  for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+    QCommandLineCacheFile state;
+    bool exists;
+
+    in >> state.path >> exists >> state.size >> state.modified >> state.changed >> state.permissions;
+    state.exists = exists;
+    if (!(fileState(state.path) == state))
+      return false;
+  }
+
+  in >> count;
+  for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+    QCommandLineEvent event;
+    qint8 kind;
+    qint32 id;
+
+    in >> kind >> id >> event.name >> event.value;
+    event.kind = (QCommandLineEvent::Kind) kind;
+    event.id = id;
+    events << event;
+  }
+
+  if (in.status() != QDataStream::Ok)
+    return false;
+
+  /* Only successful parses are saved */
+  foreach (const QCommandLineEvent & event, events)
+    if (event.kind == QCommandLineEvent::Error)
+      return false;
+
+  foreach (const QCommandLineEvent & event, events) {
+    switch (event.kind) {
+    case QCommandLineEvent::Switch:
+      handler.switchFound(event.id, event.name);
+      break;
+    case QCommandLineEvent::Option:
+      if (isRange(spec, event.name))
+	handler.rangeFound(event.id, event.name, QCommandLineRange::fromString(event.value));
+      else
+	handler.optionFound(event.id, event.name, event.value);
+      break;
+    case QCommandLineEvent::Param:
+      handler.paramFound(event.id, event.name, event.value);
+      break;
+    case QCommandLineEvent::Error:
+      break;
+    }
+  }
+  return true;
+}
+
+void
+QCommandLineCache::record(QCommandLineEvent::Kind kind, int id, const QString & name,
+			  const QString & value)
+{
+  QCommandLineEvent event;
+
+  event.kind = kind;
+  event.id = id;
+  event.name = name;
+  event.value = value;
+  events << event;
+}
+
+void
+QCommandLineCache::switchFound(int id, const QString & name)
+{
+  record(QCommandLineEvent::Switch, id, name, QString());
+  handler.switchFound(id, name);
+}
+
+void
+QCommandLineCache::optionFound(int id, const QString & name, const QString & value)
+{
+  record(QCommandLineEvent::Option, id, name, value);
+  handler.optionFound(id, name, value);
+}
+
+void
+QCommandLineCache::paramFound(int id, const QString & name, const QString & value)
+{
+  record(QCommandLineEvent::Param, id, name, value);
+  handler.paramFound(id, name, value);
+}
+
+void
+QCommandLineCache::rangeFound(int id, const QString & name, const QCommandLineRange & range)
+{
+  record(QCommandLineEvent::Option, id, name, range.toString());
+  handler.rangeFound(id, name, range);
+}
+
+void
+QCommandLineCache::errorFound(const QCommandLineError & error)
+{
+  handler.errorFound(error);
+}
+
+bool
+QCommandLineCache::save(const QString & fileName, const QByteArray & key)
+{
+  QList< QCommandLineCacheFile > files;
+  QSet< QString > checked;
+  QTemporaryFile tmp(fileName + QLatin1String(".XXXXXX"));
+
+  for (int i = 0; i < spec.entries.size(); ++i)
+    if (spec.validators.at(i).checks & pathChecks)
+      checked << spec.entries.at(i)->longName;
+
+  /* Values checked against the filesystem */
+  foreach (const QCommandLineEvent & event, events) {
+    if (event.kind == QCommandLineEvent::Switch || !checked.contains(event.name))
+      continue;
+    files << fileState(event.value);
+  }
+
+  QString dir = QFileInfo(fileName).path();
+
+  if (!QDir(dir).exists()) {
+    if (!QDir().mkpath(dir))
+      return false;
+    QFile::setPermissions(dir, QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner);
+  }
+
+  /* Created readable and writable by its owner only */
+  if (!tmp.open())
+    return false;
+
+  QDataStream out(&tmp);
+
+  out.setVersion(QDataStream::Qt_4_6);
+  out << cacheMagic << cacheVersion << key;
+
+  out << (quint32) files.size();
+  foreach (const QCommandLineCacheFile & file, files)
+    out << file.path << file.exists << file.size << file.modified << file.changed << file.permissions;
+
+  out << (quint32) events.size();
+  foreach (const QCommandLineEvent & event, events)
+    out << (qint8) event.kind << (qint32) event.id << event.name << event.value;
+
+  if (out.status() != QDataStream::Ok || !tmp.flush())
+    return false;
+
+  /* Readers see the old file, none or the new one, never a partial one */
+  tmp.setAutoRemove(false);
+  QFile::remove(fileName);
+  if (!tmp.rename(fileName)) {
+    tmp.remove();
+    return false;
+  }
+  prune(dir);
+  return true;
+}
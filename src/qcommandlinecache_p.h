@@ -0,0 +1,72 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef QCOMMAND_LINE_CACHE_P_H
+# define QCOMMAND_LINE_CACHE_P_H
+
+#include <QtCore/QList>
+
+#include "qcommandlinecore_p.h"
+
+/*
+ * On-disk cache of successful parse() results.
+ *
+ * Each file holds the results for a configuration and argument vector,
+ * named after the 64 bits FNV-1a hash of their key, with the key itself
+ * and the state of the files checked by validators: the results are only
+ * replayed for the same key, while these files did not change. Files not
+ * owned by the user, or writable by others, are ignored. Files are memory
+ * mapped when read, and written to a temporary file renamed once complete.
+ * Results are kept as QCommandLineEvent, a Range as an Option written
+ * like "1,5-9". Each write drops the files of the directory older than a
+ * month, and the oldest ones beyond 256.
+ */
+class QCommandLineCache : public QCommandLineHandler {
+public:
+    QCommandLineCache(const QCommandLineSpec & spec, QCommandLineHandler & handler);
+
+    /* The configuration and arguments, empty if they can't be cached */
+    static QByteArray key(const QCommandLineSpec & spec, const QCommandLineArguments & args);
+    /* Path of the cache file for this key, empty if the key is */
+    static QString fileName(const QByteArray & key, const QString & dir);
+    /* Give the cached results to handler, returns false if there are none */
+    static bool replay(const QCommandLineSpec & spec, const QString & fileName,
+		       const QByteArray & key, QCommandLineHandler & handler);
+
+    /* Record the results given to the handler */
+    virtual void switchFound(int id, const QString & name);
+    virtual void optionFound(int id, const QString & name, const QString & value);
+    virtual void paramFound(int id, const QString & name, const QString & value);
+    virtual void rangeFound(int id, const QString & name, const QCommandLineRange & range);
+    virtual void errorFound(const QCommandLineError & error);
+
+    /* Write what was recorded */
+    bool save(const QString & fileName, const QByteArray & key);
+
+private:
+    void record(QCommandLineEvent::Kind kind, int id, const QString & name,
+		const QString & value);
+
+    const QCommandLineSpec & spec;
+    QCommandLineHandler & handler;
+    QList< QCommandLineEvent > events;
+};
+
+#endif
@@ -0,0 +1,1437 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QFileInfo>
+#include <QtCore/QSet>
+#include <QtCore/QTextStream>
+#include <QtCore/QThread>
+#include <QDebug>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef Q_OS_UNIX
+# include <sys/ioctl.h>
+# include <unistd.h>
+#endif
+
+#include "qcommandlinecore.h"
+#include "qcommandlinecore_p.h"
+#include "qcommandlinecache_p.h"
+#include "qcommandlineglob_p.h"
+#include "qcommandlinerange.h"
+#include "qcommandlinevalidator_p.h"
+
+/* Messages are marked with QT_TRANSLATE_NOOP("QCommandLine", ...) */
+static inline QString
+translate(const char *text)
+{
+  return QCoreApplication::translate("QCommandLine", text);
+}
+
+/*
+ * Qt's atomics are inline assembly ThreadSanitizer does not see: tell it
+ * about the ordering the spec publication relies on.
+ */
+#ifdef QCOMMANDLINE_SANITIZE_THREAD
+extern "C" void AnnotateHappensBefore(const char *file, int line, const volatile void *addr);
+extern "C" void AnnotateHappensAfter(const char *file, int line, const volatile void *addr);
+# define HAPPENS_BEFORE(addr) AnnotateHappensBefore(__FILE__, __LINE__, addr)
+# define HAPPENS_AFTER(addr) AnnotateHappensAfter(__FILE__, __LINE__, addr)
+#else
+# define HAPPENS_BEFORE(addr) do { } while (0)
+# define HAPPENS_AFTER(addr) do { } while (0)
+#endif
+
+/* Width of the terminal help is shown on, 80 if it can't be guessed */
+static int
+terminalWidth()
+{
+#if defined(Q_OS_UNIX) && defined(TIOCGWINSZ)
+  struct winsize ws;
+
+  if (ioctl(STDERR_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0)
+    return ws.ws_col;
+#endif
+  bool ok;
+  int columns = qgetenv("COLUMNS").toInt(&ok);
+
+  if (ok && columns > 0)
+    return columns;
+  return 80;
+}
+
+static void
+pad(QTextStream & out, int count)
+{
+  while (count-- > 0)
+    out << ' ';
+}
+
+/* Write text, wrapped to fit between column and width */
+static void
+writeWrapped(QTextStream & out, const QString & text, int column, int width)
+{
+  int avail = qMax(width - column, 20);
+  int pos = 0;
+  int len = 0;
+
+  while (pos < text.size()) {
+    if (text.at(pos) == QLatin1Char('\n')) {
+      out << '\n';
+      pad(out, column);
+      len = 0;
+      pos++;
+      continue;
+    }
+    if (text.at(pos).isSpace()) {
+      pos++;
+      continue;
+    }
+
+    int end = pos;
+
+    while (end < text.size() && !text.at(end).isSpace())
+      end++;
+
+    if (len && len + 1 + end - pos > avail) {
+      out << '\n';
+      pad(out, column);
+      len = 0;
+    } else if (len) {
+      out << ' ';
+      len++;
+    }
+    out << text.mid(pos, end - pos);
+    len += end - pos;
+    pos = end;
+  }
+  out << '\n';
+}
+
+/* Rough size of the memory used by a string */
+static qint64
+stringBytes(const QString & s)
+{
+  return sizeof(QString) + 4 * sizeof(int) + s.capacity() * sizeof(QChar);
+}
+
+/* Rough size of the memory used by the nodes and buckets of a name table */
+static qint64
+keysBytes(const QHash < QString, QCommandLineKey > & keys)
+{
+  return keys.capacity() * sizeof(void *) +
+    keys.size() * (sizeof(void *) + sizeof(uint) + sizeof(QCommandLineKey) +
+		   stringBytes(QString(1, QLatin1Char(' '))));
+}
+
+static void
+addSlot(QCommandLineSpec & spec, QHash < QString, int > & interned,
+	const QCommandLineConfigEntry & entry, int id,
+	const QCommandLineValidator & validator = QCommandLineValidator())
+{
+  QCommandLineKey key = { spec.entries.size(), false };
+
+  if (!interned.contains(entry.longName)) {
+    interned[entry.longName] = spec.nameStrings.size();
+    spec.nameStrings << entry.longName;
+    spec.nameIds << id;
+  }
+
+  spec.names << interned[entry.longName];
+  spec.entries << &entry;
+  spec.validators << validator;
+  if (validator.checks & QCommandLineValidator::Pattern) {
+    QRegExp rx(validator.pattern);
+
+    /* Compile it now: parsers copy it, a copy of an uncompiled QRegExp compiles the original */
+    rx.isValid();
+    spec.patterns << rx;
+  } else {
+    spec.patterns << QRegExp();
+  }
+
+  if (entry.type == QCommandLineCore::Param)
+    spec.params << key.slot;
+  else
+    spec.shortKeys[entry.shortName] = key;
+  spec.longKeys[entry.longName] = key;
+}
+
+QCommandLineSpec *
+QCommandLineCorePrivate::build()
+{
+  QHash < QString, int > interned;
+  QCommandLineSpec *built = new QCommandLineSpec;
+  QCommandLineSpec & spec = *built;
+
+  /* Shared with config until a writer changes it */
+  spec.config = config;
+  spec.generation = generation;
+  spec.ref.ref();
+
+  for (int i = 0; i < spec.config.size(); ++i) {
+    const QCommandLineConfigEntry & entry = spec.config.at(i);
+
+    if (entry.type == QCommandLineCore::Section)
+      continue;
+
+    if (entry.type == QCommandLineCore::Switch)
+      addSlot(spec, interned, entry, ids.at(i));
+    else
+      addSlot(spec, interned, entry, ids.at(i), validators.value(entry.longName));
+  }
+
+  if (help)
+    addSlot(spec, interned, QCommandLineCore::helpEntry, QCommandLineCore::HelpId);
+  if (version)
+    addSlot(spec, interned, QCommandLineCore::versionEntry, QCommandLineCore::VersionId);
+
+  spec.bytes = sizeof(spec) +
+    spec.entries.capacity() * sizeof(void *) +
+    spec.validators.capacity() * sizeof(QCommandLineValidator) +
+    spec.patterns.capacity() * sizeof(QRegExp) +
+    (spec.names.capacity() + spec.nameIds.capacity() + spec.params.capacity()) * sizeof(int) +
+    spec.nameStrings.size() * (sizeof(void *) + sizeof(QString)) +
+    keysBytes(spec.shortKeys) + keysBytes(spec.longKeys);
+
+  return built;
+}
+
+const QCommandLineSpec *
+QCommandLineCorePrivate::acquire()
+{
+  QCommandLineSpec *spec;
+
+  /* The first parse after a change builds the new spec */
+  if (dirty.fetchAndAddOrdered(0)) {
+    QMutexLocker locker(&writeLock);
+
+    /* Low memory mode: tables for this parse only */
+    if (lowMemory)
+      return build();
+    if (dirty.fetchAndAddOrdered(0)) {
+      publish(build());
+      dirty.fetchAndStoreOrdered(0);
+    }
+  }
+
+  loading.ref();
+  spec = published.fetchAndAddOrdered(0);
+  if (spec) {
+    HAPPENS_AFTER(spec);
+    spec->ref.ref();
+  }
+  HAPPENS_BEFORE(&loading);
+  loading.deref();
+  if (spec)
+    return spec;
+
+  /* Low memory mode was enabled since dirty was checked */
+  QMutexLocker locker(&writeLock);
+
+  return build();
+}
+
+void
+QCommandLineCorePrivate::release(const QCommandLineSpec *spec)
+{
+  QCommandLineSpec *used = const_cast< QCommandLineSpec * >(spec);
+
+  /* The last parser using a replaced spec frees it */
+  HAPPENS_BEFORE(&used->ref);
+  if (!used->ref.deref()) {
+    HAPPENS_AFTER(&used->ref);
+    delete used;
+  }
+}
+
+/* Replace the published spec by spec, or unpublish it if spec is 0 */
+void
+QCommandLineCorePrivate::publish(QCommandLineSpec *spec)
+{
+  QCommandLineSpec *old;
+
+  if (spec)
+    HAPPENS_BEFORE(spec);
+  old = published.fetchAndStoreOrdered(spec);
+  if (!old)
+    return ;
+
+  /* Parsers which loaded old have referenced it once none is loading */
+  while (loading.fetchAndAddOrdered(0))
+    QThread::yieldCurrentThread();
+  HAPPENS_AFTER(&loading);
+  release(old);
+}
+
+const QCommandLineHelpLayout &
+QCommandLineCorePrivate::helpLayout()
+{
+  if (!helpDirty)
+    return layout;
+
+  layout.labels.clear();
+  layout.labelWidth = 0;
+
+  foreach (QCommandLineConfigEntry entry, config) {
+    QString val;
+
+    if (entry.type == QCommandLineCore::Option)
+      val = QLatin1String("-") + QString(entry.shortName) +
+	QLatin1String(",--") + entry.longName + QLatin1String("=<val>");
+    if (entry.type == QCommandLineCore::Range)
+      val = QLatin1String("-") + QString(entry.shortName) +
+	QLatin1String(",--") + entry.longName + QLatin1String("=<range>");
+    if (entry.type == QCommandLineCore::Switch)
+      val = QLatin1String("-") + QString(entry.shortName) + QLatin1String(",--") + entry.longName;
+    if (entry.type == QCommandLineCore::Param)
+      val = entry.longName;
+
+    if (val.size() > layout.labelWidth)
+      layout.labelWidth = val.size();
+
+    layout.labels.append(val);
+  }
+
+  helpDirty = false;
+  return layout;
+}
+
+QCommandLineCorePrivate::QCommandLineCorePrivate()
+  : version(false), help(false), lowMemory(false), helpWidth(0),
+    argc(0), argv(0), sourceArgc(0), sourceArgv(0), stream(stdin), separator('\n'), nextId(0),
+    published(0), loading(0), dirty(1), generation(0), helpDirty(true), peakMemory(0)
+{
+}
+
+QCommandLineCorePrivate::~QCommandLineCorePrivate()
+{
+  QCommandLineSpec *spec = published.fetchAndStoreOrdered(0);
+
+  if (spec)
+    release(spec);
+}
+
+/* Built again by the next parse */
+void
+QCommandLineCorePrivate::invalidate()
+{
+  generation++;
+  dirty.fetchAndStoreOrdered(1);
+  helpDirty = true;
+}
+
+/* Warnings are given once, when the entry is added */
+int
+QCommandLineCorePrivate::add(const QCommandLineConfigEntry & entry)
+{
+  if (entry.type != QCommandLineCore::Section) {
+    if (entry.type != QCommandLineCore::Param && entry.shortName == QLatin1Char('\0'))
+      qWarning() << QLatin1String("QCommandLine: Empty shortname detected");
+    if (entry.longName.isEmpty())
+      qWarning() << QLatin1String("QCommandLine: Empty longname detected");
+    if (entry.type != QCommandLineCore::Param && shortNames.value(entry.shortName))
+      qWarning() << QLatin1String("QCommandLine: Duplicated shortname detected ") << entry.shortName;
+    if (shortNames.value(entry.longName))
+      qWarning() << QLatin1String("QCommandLine: Duplicated longname detected ") << entry.longName;
+    if (entry.type != QCommandLineCore::Param)
+      shortNames[entry.shortName]++;
+  }
+
+  config << entry;
+  ids << nextId;
+  return nextId++;
+}
+
+void
+QCommandLineCorePrivate::removeAt(int i)
+{
+  const QCommandLineConfigEntry & entry = config.at(i);
+
+  if (entry.type != QCommandLineCore::Section && entry.type != QCommandLineCore::Param &&
+      !--shortNames[entry.shortName])
+    shortNames.remove(entry.shortName);
+  config.removeAt(i);
+  ids.removeAt(i);
+}
+
+void
+QCommandLineCorePrivate::clear()
+{
+  config.clear();
+  ids.clear();
+  shortNames.clear();
+  nextId = 0;
+}
+
+QCommandLineArguments
+QCommandLineCorePrivate::arguments() const
+{
+  if (argv)
+    return QCommandLineArguments(argc, argv);
+  return QCommandLineArguments(args);
+}
+
+/* Translated when help is shown, no translator is installed yet here */
+static const char * const helpDescr = QT_TRANSLATE_NOOP("QCommandLine", "Display this help and exit");
+static const char * const versionDescr = QT_TRANSLATE_NOOP("QCommandLine", "Display version and exit");
+
+const QCommandLineConfigEntry QCommandLineCore::helpEntry = { QCommandLineCore::Switch, QLatin1Char('h'), QLatin1String("help"), QLatin1String(helpDescr), QCommandLineCore::Optional };
+
+const QCommandLineConfigEntry QCommandLineCore::versionEntry = { QCommandLineCore::Switch, QLatin1Char('V'), QLatin1String("version"), QLatin1String(versionDescr), QCommandLineCore::Optional };
+
+/* Description of an entry in help, translated in the QCommandLine
+   context: the built-in ones, and those an application marked with
+   QT_TRANSLATE_NOOP("QCommandLine", ...) */
+static QString
+description(const QCommandLineConfigEntry & entry)
+{
+  if (entry.descr.isEmpty())
+    return entry.descr;
+  return QCoreApplication::translate("QCommandLine", entry.descr.toUtf8().constData(),
+				     0, QCoreApplication::UnicodeUTF8);
+}
+
+QCommandLineError::QCommandLineError(const char *message, const QStringList & args)
+  : message(message), args(args)
+{
+}
+
+QString
+QCommandLineError::toString() const
+{
+  QString text = translate(message);
+  QString s;
+
+  /* In one pass, so that a value containing %1 is not replaced again */
+  for (int i = 0; i < text.size(); ++i) {
+    int n = 0, j = i + 1;
+
+    if (text.at(i) == QLatin1Char('%'))
+      while (j < text.size() && j < i + 3 && text.at(j).isDigit())
+	n = n * 10 + text.at(j++).digitValue();
+    if (n < 1 || n > args.size()) {
+      s += text.at(i);
+      continue;
+    }
+    s += args.at(n - 1);
+    i = j - 1;
+  }
+  return s;
+}
+
+QCommandLineHandler::~QCommandLineHandler()
+{
+}
+
+void
+QCommandLineHandler::switchFound(int, const QString &)
+{
+}
+
+void
+QCommandLineHandler::optionFound(int, const QString &, const QString &)
+{
+}
+
+void
+QCommandLineHandler::paramFound(int, const QString &, const QString &)
+{
+}
+
+void
+QCommandLineHandler::rangeFound(int id, const QString & name, const QCommandLineRange & range)
+{
+  optionFound(id, name, range.toString());
+}
+
+void
+QCommandLineHandler::errorFound(const QCommandLineError & error)
+{
+  parseError(error.toString());
+}
+
+void
+QCommandLineHandler::parseError(const QString &)
+{
+}
+
+void
+QCommandLineResult::switchFound(int id, const QString & name)
+{
+  QCommandLineEvent event;
+
+  event.kind = QCommandLineEvent::Switch;
+  event.id = id;
+  event.name = name;
+  events << event;
+}
+
+void
+QCommandLineResult::optionFound(int id, const QString & name, const QString & value)
+{
+  QCommandLineEvent event;
+
+  event.kind = QCommandLineEvent::Option;
+  event.id = id;
+  event.name = name;
+  event.value = value;
+  events << event;
+}
+
+void
+QCommandLineResult::paramFound(int id, const QString & name, const QString & value)
+{
+  QCommandLineEvent event;
+
+  event.kind = QCommandLineEvent::Param;
+  event.id = id;
+  event.name = name;
+  event.value = value;
+  events << event;
+}
+
+void
+QCommandLineResult::parseError(const QString & error)
+{
+  QCommandLineEvent event;
+
+  event.kind = QCommandLineEvent::Error;
+  event.id = QCommandLineCore::InvalidId;
+  event.value = error;
+  events << event;
+}
+
+int
+QCommandLineResult::switchCount(const QString & name) const
+{
+  int count = 0;
+
+  foreach (const QCommandLineEvent & event, events)
+    if (event.kind == QCommandLineEvent::Switch && event.name == name)
+      count++;
+  return count;
+}
+
+int
+QCommandLineResult::switchCount(int id) const
+{
+  int count = 0;
+
+  foreach (const QCommandLineEvent & event, events)
+    if (event.kind == QCommandLineEvent::Switch && event.id == id)
+      count++;
+  return count;
+}
+
+QStringList
+QCommandLineResult::values(const QString & name) const
+{
+  QStringList values;
+
+  foreach (const QCommandLineEvent & event, events)
+    if ((event.kind == QCommandLineEvent::Option || event.kind == QCommandLineEvent::Param)
+	&& event.name == name)
+      values << event.value;
+  return values;
+}
+
+QStringList
+QCommandLineResult::values(int id) const
+{
+  QStringList values;
+
+  foreach (const QCommandLineEvent & event, events)
+    if ((event.kind == QCommandLineEvent::Option || event.kind == QCommandLineEvent::Param)
+	&& event.id == id)
+      values << event.value;
+  return values;
+}
+
+QString
+QCommandLineResult::errorString() const
+{
+  foreach (const QCommandLineEvent & event, events)
+    if (event.kind == QCommandLineEvent::Error)
+      return event.value;
+  return QString();
+}
+
+QCommandLineCore::QCommandLineCore()
+  : d(new QCommandLineCorePrivate)
+{
+}
+
+QCommandLineCore::QCommandLineCore(int argc, char *argv[],
+				   const QCommandLineConfig & config)
+  : d(new QCommandLineCorePrivate)
+{
+  setArguments(argc, argv);
+  setConfig(config);
+  enableHelp(true);
+  enableVersion(true);
+}
+
+QCommandLineCore::QCommandLineCore(const QStringList args,
+				   const QCommandLineConfig & config)
+  : d(new QCommandLineCorePrivate)
+{
+  setArguments(args);
+  setConfig(config);
+  enableHelp(true);
+  enableVersion(true);
+}
+
+QCommandLineCore::~QCommandLineCore()
+{
+  delete d;
+}
+
+void
+QCommandLineCore::setConfig(const QCommandLineConfig & config)
+{
+  QMutexLocker locker(&d->writeLock);
+
+  d->clear();
+  foreach (const QCommandLineConfigEntry & entry, config)
+    d->add(entry);
+  d->invalidate();
+}
+
+void
+QCommandLineCore::setConfig(const QCommandLineConfigEntry config[])
+{
+  QMutexLocker locker(&d->writeLock);
+
+  d->clear();
+  while (config->type) {
+    d->add(*config);
+    config++;
+  }
+  d->invalidate();
+}
+
+QCommandLineConfig
+QCommandLineCore::config()
+{
+  QMutexLocker locker(&d->writeLock);
+
+  return d->config;
+}
+
+void
+QCommandLineCore::setArguments(int argc, char *argv[])
+{
+  d->args.clear();
+  d->argc = 0;
+  d->argv = 0;
+  d->sourceArgc = argc;
+  d->sourceArgv = argv;
+
+  if (d->lowMemory) {
+    d->argc = argc;
+    d->argv = argv;
+    return ;
+  }
+
+  for (int i = 0; i < argc; i++)
+    d->args.append(QLatin1String(argv[i]));
+}
+
+void
+QCommandLineCore::setArguments(const QStringList & args)
+{
+  d->args = args;
+  d->argc = 0;
+  d->argv = 0;
+  d->sourceArgc = 0;
+  d->sourceArgv = 0;
+}
+
+QStringList
+QCommandLineCore::arguments() const
+{
+  QStringList args;
+
+  if (!d->argv)
+    return d->args;
+
+  for (int i = 0; i < d->argc; i++)
+    args.append(QLatin1String(d->argv[i]));
+  return args;
+}
+
+void
+QCommandLineCore::enableHelp(bool enable)
+{
+  QMutexLocker locker(&d->writeLock);
+
+  d->help = enable;
+  d->invalidate();
+}
+
+bool
+QCommandLineCore::helpEnabled() const
+{
+  return d->help;
+}
+
+void
+QCommandLineCore::enableVersion(bool enable)
+{
+  QMutexLocker locker(&d->writeLock);
+
+  d->version = enable;
+  d->invalidate();
+}
+
+bool
+QCommandLineCore::versionEnabled() const
+{
+  return d->version;
+}
+
+void
+QCommandLineCore::enableLowMemory(bool enable)
+{
+  QMutexLocker locker(&d->writeLock);
+
+  if (d->lowMemory != enable) {
+    d->lowMemory = enable;
+    /* Tables are built by each parse in low memory mode */
+    if (enable)
+      d->publish(0);
+    d->invalidate();
+  }
+
+  /* Drop, or make, the copy of an argv given before, by the constructor */
+  if (d->sourceArgv)
+    setArguments(d->sourceArgc, d->sourceArgv);
+}
+
+bool
+QCommandLineCore::lowMemoryEnabled() const
+{
+  return d->lowMemory;
+}
+
+qint64
+QCommandLineCore::peakMemoryEstimate() const
+{
+  return d->peakMemory;
+}
+
+void
+QCommandLineCore::setParamStream(FILE *stream, char separator)
+{
+  d->stream = stream;
+  d->separator = separator;
+}
+
+/*
+ * Report each separator terminated record read from stream as a param,
+ * reading it by chunks so that memory use does not depend on its size.
+ * Returns the number of records, or -1 if reading failed.
+ */
+static int
+readParams(FILE *stream, char separator, QCommandLineHandler & handler,
+	   int id, const QString & name)
+{
+  static const int chunkSize = 64 * 1024;
+  QByteArray chunk(chunkSize, '\0');
+  QByteArray partial; /* record split between two chunks */
+  int count = 0;
+  size_t len;
+
+  do {
+    len = fread(chunk.data(), 1, chunkSize, stream);
+
+    const char *p = chunk.constData();
+    const char *end = p + len;
+
+    while (p < end) {
+      const char *sep = (const char *) memchr(p, separator, end - p);
+
+      if (!sep) {
+	partial.append(p, end - p);
+	break;
+      }
+
+      if (!partial.isEmpty()) {
+	partial.append(p, sep - p);
+	handler.paramFound(id, name, QString::fromLocal8Bit(partial.constData(), partial.size()));
+	partial.clear();
+	count++;
+      } else if (sep != p) {
+	handler.paramFound(id, name, QString::fromLocal8Bit(p, sep - p));
+	count++;
+      }
+      p = sep + 1;
+    }
+  } while (len == (size_t) chunkSize);
+
+  if (ferror(stream))
+    return -1;
+
+  if (!partial.isEmpty()) {
+    handler.paramFound(id, name, QString::fromLocal8Bit(partial.constData(), partial.size()));
+    count++;
+  }
+  return count;
+}
+
+void
+QCommandLineCore::setCacheDir(const QString & dir)
+{
+  d->cacheDir = dir;
+}
+
+QString
+QCommandLineCore::cacheDir() const
+{
+  return d->cacheDir;
+}
+
+bool
+QCommandLineCore::parse(QCommandLineHandler & handler)
+{
+  return parseArguments(d->arguments(), handler, d->peakMemory);
+}
+
+bool
+QCommandLineCore::parse(const QStringList & args, QCommandLineHandler & handler)
+{
+  qint64 peakMemory;
+
+  return parseArguments(QCommandLineArguments(args), handler, peakMemory);
+}
+
+bool
+QCommandLineCore::parseArguments(const QCommandLineArguments & args,
+				 QCommandLineHandler & handler, qint64 & peakMemory)
+{
+  const QCommandLineSpec *spec = d->acquire();
+  QByteArray cacheKey;
+  QString cacheFile;
+  bool ok;
+
+  if (!d->cacheDir.isEmpty() && !args.untrusted) {
+    cacheKey = QCommandLineCache::key(*spec, args);
+    cacheFile = QCommandLineCache::fileName(cacheKey, d->cacheDir);
+  }
+
+  if (cacheFile.isEmpty()) {
+    ok = parseArguments(*spec, args, handler, peakMemory);
+  } else if (QCommandLineCache::replay(*spec, cacheFile, cacheKey, handler)) {
+    ok = true;
+  } else {
+    QCommandLineCache cache(*spec, handler);
+
+    ok = parseArguments(*spec, args, cache, peakMemory);
+    if (ok)
+      cache.save(cacheFile, cacheKey);
+  }
+
+  d->release(spec);
+  return ok;
+}
+
+bool
+QCommandLineCore::parseArguments(const QCommandLineSpec & spec, const QCommandLineArguments & args,
+				 QCommandLineHandler & handler, qint64 & peakMemory)
+{
+  /* Only detached when a Mandatory entry is found */
+  QHash < QString, QCommandLineKey > conf = spec.shortKeys;
+  QHash < QString, QCommandLineKey > confLong = spec.longKeys;
+  bool confDetached = false;
+  /* Indexed by interned name */
+  QVector < QStringList > optionsFound(spec.nameStrings.size());
+  QVector < QCommandLineRange > rangesFound(spec.nameStrings.size());
+  QVector < int > switchsFound(spec.nameStrings.size());
+  QVector < int > options, ranges, switchs;
+  /* Values of Unique options, by interned name */
+  QHash < int, QSet < QString > > optionsSeen;
+  int argc = args.count();
+  /* Params and errors go through it, to be given in order with the checked values */
+  QCommandLineChecker checker(spec, handler);
+  /* The rest of stacked args like `tar -xzf`, parsed as the next argument */
+  QString stacked;
+  bool hasStacked = false;
+  /* Current Param, and whether it was already found */
+  int nextParam = 0;
+  bool paramSeen = false;
+  /* Memory used by the arguments and the tables, then by what was found */
+  qint64 base = spec.bytes + optionsFound.size() * sizeof(QStringList) +
+    rangesFound.size() * sizeof(QCommandLineRange) +
+    switchsFound.size() * sizeof(int) * 3;
+  qint64 used = 0;
+
+  bool allparam = false;
+
+  checker.paramPaths = !args.untrusted;
+
+  if (args.list)
+    foreach (const QString & arg, *args.list)
+      base += sizeof(void *) + stringBytes(arg);
+  peakMemory = base;
+
+  for (int i = 1; i < argc || hasStacked; ) {
+    QString arg;
+    bool param = true, shrt = false;
+
+    if (hasStacked) {
+      arg = stacked;
+      hasStacked = false;
+    } else {
+      checker.argument = i;
+      arg = args.at(i++);
+    }
+    peakMemory = qMax(peakMemory, base + used + checker.bytes + 2 * stringBytes(arg));
+
+    /* A lone '-' reads a Multiple Stream param from the input stream, unless after '+' */
+    if (!allparam && arg == QLatin1String("-") && nextParam < spec.params.size()) {
+      int slot = spec.params.at(nextParam);
+      const QCommandLineConfigEntry & entry = *spec.entries.at(slot);
+
+      if ((entry.flags & QCommandLineCore::Stream) && (entry.flags & QCommandLineCore::Multiple)) {
+	int count;
+
+	/* A client can't make the program read its input */
+	if (args.untrusted) {
+	  paramSeen = true;
+	  continue;
+	}
+
+	peakMemory = qMax(peakMemory, base + used + checker.bytes + 64 * 1024);
+	checker.slot = slot;
+	count = readParams(d->stream, d->separator, checker,
+			   spec.nameIds.at(spec.names.at(slot)), entry.longName);
+	if (checker.failed)
+	  return false;
+	if (count < 0) {
+	  checker.errorFound(QCommandLineError(QT_TRANSLATE_NOOP("QCommandLine", "Can't read %1 from the input"),
+					       QStringList() << entry.longName));
+	  return false;
+	}
+	if (count)
+	  paramSeen = true;
+	continue;
+      }
+    }
+
+    /* A '+' was found, all remaining options are params */
+    if (allparam)
+      param = true;
+    else if (arg.startsWith(QLatin1String("--"))) {
+      param = false;
+      shrt = false;
+      arg = arg.mid(2);
+    } else if (arg.startsWith(QLatin1Char('-')) || arg.startsWith(QLatin1Char('+'))) {
+      if (arg.startsWith(QLatin1Char('+')))
+	allparam = true;
+      param = false;
+      shrt = true;
+      /* Handle stacked args like `tar -xzf` */
+      if (arg.size() > 2) {
+	stacked = arg.mid(0, 1) + arg.mid(2);
+	hasStacked = true;
+	arg = arg.mid(1, 1);
+      } else {
+	arg = arg.mid(1);
+      }
+    }
+
+    /* Handle params */
+    if (param) {
+      if (nextParam == spec.params.size()) {
+	checker.errorFound(QCommandLineError(QT_TRANSLATE_NOOP("QCommandLine", "Unknown param: %1"), QStringList() << arg));
+	return false;
+      }
+
+      int slot = spec.params.at(nextParam);
+      const QCommandLineConfigEntry & entry = *spec.entries.at(slot);
+
+      paramSeen = true;
+      checker.slot = slot;
+      /* Unmatched patterns are given as is, like shells do */
+      if (args.untrusted ||
+	  !(entry.flags & QCommandLineCore::Glob) || !(entry.flags & QCommandLineCore::Multiple) ||
+	  !QCommandLineGlob::hasWildcards(arg) ||
+	  !QCommandLineGlob::expand(arg, checker, spec.nameIds.at(spec.names.at(slot)), entry.longName))
+	checker.paramFound(spec.nameIds.at(spec.names.at(slot)), entry.longName, arg);
+      if (checker.failed)
+	return false;
+
+      if (!(entry.flags & QCommandLineCore::Multiple)) {
+	nextParam++;
+	paramSeen = false;
+      }
+
+    } else { /* Options and switchs* */
+      QString key;
+      QString value;
+      int idx = arg.indexOf(QLatin1Char('='));
+
+      if (idx != -1) {
+	key = arg.mid(0, idx);
+	value = arg.mid(idx + 1);
+      } else {
+	key = arg;
+      }
+
+      QHash < QString, QCommandLineKey > & c = shrt ? conf : confLong;
+      QHash < QString, QCommandLineKey >::const_iterator it = c.constFind(key);
+
+      if (it == c.constEnd()) {
+	checker.errorFound(QCommandLineError(QT_TRANSLATE_NOOP("QCommandLine", "Unknown option: %1"), QStringList() << key));
+	return false;
+      }
+
+      QCommandLineKey found = it.value();
+      const QCommandLineConfigEntry & entry = *spec.entries.at(found.slot);
+      int name = spec.names.at(found.slot);
+
+      if (entry.type == QCommandLineCore::Switch) {
+	if (!switchsFound[name])
+	  switchs << name;
+	if (entry.flags & QCommandLineCore::Multiple)
+	  switchsFound[name]++;
+	else
+	  switchsFound[name] = 1;
+      } else {
+	if (idx == -1) {
+	  /* The value is the next argument */
+	  if (hasStacked)
+	    value = stacked;
+	  else if (i < argc)
+	    value = args.at(i);
+
+	  if ((!hasStacked && i == argc) || value.startsWith(QLatin1Char('-'))) {
+	    checker.errorFound(QCommandLineError(QT_TRANSLATE_NOOP("QCommandLine", "Option %1 need a value"),
+						 QStringList() << key));
+	    return false;
+	  }
+
+	  if (hasStacked)
+	    hasStacked = false;
+	  else
+	    checker.argument = i++;
+	}
+
+	if (entry.type == QCommandLineCore::Range) {
+	  bool ok;
+	  QCommandLineRange range = QCommandLineRange::fromString(value, &ok);
+
+	  if (!ok) {
+	    checker.errorFound(QCommandLineError(QT_TRANSLATE_NOOP("QCommandLine", "Option %1 needs a list of numbers like 1,5-9: %2"),
+						 QStringList() << key << value));
+	    return false;
+	  }
+
+	  /* Only the bounds are kept, values given many times are merged */
+	  used -= rangesFound[name].intervals().size() * sizeof(QCommandLineRange::Interval);
+	  if (rangesFound[name].isEmpty())
+	    ranges << name;
+	  if (entry.flags & QCommandLineCore::Multiple)
+	    rangesFound[name].unite(range);
+	  else
+	    rangesFound[name] = range;
+	  used += rangesFound[name].intervals().size() * sizeof(QCommandLineRange::Interval);
+	} else if ((entry.flags & QCommandLineCore::Unique) && (entry.flags & QCommandLineCore::Multiple) &&
+		   optionsSeen[name].contains(value)) {
+	  /* Only the first occurrence is kept */
+	} else {
+	  if ((entry.flags & QCommandLineCore::Unique) && (entry.flags & QCommandLineCore::Multiple)) {
+	    optionsSeen[name].insert(value);
+	    used += 2 * sizeof(void *) + sizeof(uint) + sizeof(QString);
+	  }
+
+	  if (!checker.checkOption(found.slot, value))
+	    return false;
+
+	  if (optionsFound[name].isEmpty())
+	    options << name;
+	  if (!(entry.flags & QCommandLineCore::Multiple)) {
+	    foreach (const QString & old, optionsFound[name])
+	      used -= sizeof(void *) + stringBytes(old);
+	    optionsFound[name].clear();
+	  }
+	  optionsFound[name].append(value);
+	  used += sizeof(void *) + stringBytes(value);
+	}
+      }
+
+      if ((entry.flags & QCommandLineCore::Mandatory) && !found.found) {
+	if (!confDetached) {
+	  used += keysBytes(conf) + keysBytes(confLong);
+	  confDetached = true;
+	}
+	found.found = true;
+	c[key] = found;
+	conf[entry.shortName] = found;
+	confLong[entry.shortName] = found;
+      }
+    }
+    peakMemory = qMax(peakMemory, base + used + checker.bytes);
+  }
+
+  if (!checker.flush())
+    return false;
+
+  /* Params are dropped by reparse(), a client does not give them again */
+  for (int i = nextParam; i < spec.params.size() && !args.untrusted; ++i) {
+    const QCommandLineConfigEntry & entry = *spec.entries.at(spec.params.at(i));
+
+    if ((entry.flags & QCommandLineCore::Mandatory) && !(i == nextParam && paramSeen)) {
+      handler.errorFound(QCommandLineError(QT_TRANSLATE_NOOP("QCommandLine", "Param %1 is mandatory"),
+					   QStringList() << entry.longName));
+      return false;
+    }
+  }
+
+  /* Report the missing entry with the smallest short name */
+  QHash < QString, QCommandLineKey >::const_iterator missing = conf.constEnd();
+
+  for (QHash < QString, QCommandLineKey >::const_iterator it = conf.constBegin();
+       it != conf.constEnd(); ++it) {
+    if (it.value().found || !(spec.entries.at(it.value().slot)->flags & QCommandLineCore::Mandatory))
+      continue;
+    if (missing == conf.constEnd() || it.key() < missing.key())
+      missing = it;
+  }
+
+  if (missing != conf.constEnd()) {
+    const QCommandLineConfigEntry & entry = *spec.entries.at(missing.value().slot);
+    const char *message = QT_TRANSLATE_NOOP("QCommandLine", "%1 is mandatory");
+
+    if (entry.type == QCommandLineCore::Switch)
+      message = QT_TRANSLATE_NOOP("QCommandLine", "Switch %1 is mandatory");
+    if (entry.type == QCommandLineCore::Option || entry.type == QCommandLineCore::Range)
+      message = QT_TRANSLATE_NOOP("QCommandLine", "Option %1 is mandatory");
+
+    handler.errorFound(QCommandLineError(message, QStringList() << entry.longName));
+    return false;
+  }
+
+  if (!checker.flushOptions())
+    return false;
+
+  foreach (int name, switchs) {
+    for (int i = 0; i < switchsFound.at(name); i++)
+      handler.switchFound(spec.nameIds.at(name), spec.nameStrings.at(name));
+  }
+
+  foreach (int name, options) {
+    foreach (const QString & opt, optionsFound.at(name))
+      handler.optionFound(spec.nameIds.at(name), spec.nameStrings.at(name), opt);
+  }
+
+  foreach (int name, ranges)
+    handler.rangeFound(spec.nameIds.at(name), spec.nameStrings.at(name), rangesFound.at(name));
+  return true;
+}
+
+int
+QCommandLineCore::addOption(const QChar & shortName,
+			    const QString & longName,
+			    const QString & descr,
+			    QCommandLineCore::Flags flags)
+{
+  QCommandLineConfigEntry entry;
+
+  entry.type = QCommandLineCore::Option;
+  entry.shortName = shortName;
+  entry.longName = longName;
+  entry.descr = descr;
+  entry.flags = flags;
+
+  QMutexLocker locker(&d->writeLock);
+  int id = d->add(entry);
+
+  d->invalidate();
+  return id;
+}
+
+int
+QCommandLineCore::addSwitch(const QChar & shortName,
+			    const QString & longName,
+			    const QString & descr,
+			    QCommandLineCore::Flags flags)
+{
+  QCommandLineConfigEntry entry;
+
+  entry.type = QCommandLineCore::Switch;
+  entry.shortName = shortName;
+  entry.longName = longName;
+  entry.descr = descr;
+  entry.flags = flags;
+
+  QMutexLocker locker(&d->writeLock);
+  int id = d->add(entry);
+
+  d->invalidate();
+  return id;
+}
+
+int
+QCommandLineCore::addParam(const QString & name,
+			   const QString & descr,
+			   QCommandLineCore::Flags flags)
+{
+  QCommandLineConfigEntry entry;
+
+  entry.type = QCommandLineCore::Param;
+  entry.longName = name;
+  entry.descr = descr;
+  entry.flags = flags;
+
+  QMutexLocker locker(&d->writeLock);
+  int id = d->add(entry);
+
+  d->invalidate();
+  return id;
+}
+
+int
+QCommandLineCore::addSection(const QString & title)
+{
+  QCommandLineConfigEntry entry;
+
+  entry.type = QCommandLineCore::Section;
+  entry.longName = title;
+  entry.flags = QCommandLineCore::Default;
+
+  QMutexLocker locker(&d->writeLock);
+  int id = d->add(entry);
+
+  d->invalidate();
+  return id;
+}
+
+void
+QCommandLineCore::removeOption(const QString & name)
+{
+  QMutexLocker locker(&d->writeLock);
+  int i;
+
+  for (i = 0; i < d->config.size(); ++i) {
+    if (d->config.at(i).type == QCommandLineCore::Option &&
+	(d->config.at(i).shortName == name.at(0) || d->config.at(i).longName == name)) {
+      d->removeAt(i);
+      d->invalidate();
+      return ;
+    }
+  }
+}
+
+void
+QCommandLineCore::removeSwitch(const QString & name)
+{
+  QMutexLocker locker(&d->writeLock);
+  int i;
+
+  for (i = 0; i < d->config.size(); ++i) {
+    if (d->config.at(i).type == QCommandLineCore::Switch &&
+	(d->config.at(i).shortName == name.at(0) || d->config.at(i).longName == name)) {
+      d->removeAt(i);
+      d->invalidate();
+      return ;
+    }
+  }
+}
+
+void
+QCommandLineCore::removeParam(const QString & name)
+{
+  QMutexLocker locker(&d->writeLock);
+  int i;
+
+  for (i = 0; i < d->config.size(); ++i) {
+    if (d->config.at(i).type == QCommandLineCore::Param &&
+	(d->config.at(i).shortName == name.at(0) || d->config.at(i).longName == name)) {
+      d->removeAt(i);
+      d->invalidate();
+      return ;
+    }
+  }
+}
+
+int
+QCommandLineCore::entryId(const QString & name) const
+{
+  QMutexLocker locker(&d->writeLock);
+
+  for (int i = 0; i < d->config.size(); ++i)
+    if (d->config.at(i).type != QCommandLineCore::Section &&
+	d->config.at(i).longName == name)
+      return d->ids.at(i);
+  if (d->help && name == helpEntry.longName)
+    return QCommandLineCore::HelpId;
+  if (d->version && name == versionEntry.longName)
+    return QCommandLineCore::VersionId;
+  return QCommandLineCore::InvalidId;
+}
+
+void
+QCommandLineCore::setValidator(const QString & name, const QCommandLineValidator & validator)
+{
+  if ((validator.checks & QCommandLineValidator::Pattern) && !QRegExp(validator.pattern).isValid()) {
+    qWarning() << QLatin1String("QCommandLine: Invalid pattern detected ") << validator.pattern;
+    return ;
+  }
+
+  QMutexLocker locker(&d->writeLock);
+
+  if (validator.checks == QCommandLineValidator::None)
+    d->validators.remove(name);
+  else
+    d->validators[name] = validator;
+  d->invalidate();
+}
+
+void
+QCommandLineCore::setHelpWidth(int columns)
+{
+  d->helpWidth = columns;
+}
+
+int
+QCommandLineCore::helpWidth() const
+{
+  return d->helpWidth;
+}
+
+QString
+QCommandLineCore::help(bool logo)
+{
+  QString h;
+  QTextStream out(&h);
+
+  writeHelp(out, logo);
+  out.flush();
+  return h;
+}
+
+void
+QCommandLineCore::writeHelp(QTextStream & out, bool logo)
+{
+  QMutexLocker locker(&d->writeLock);
+  const QCommandLineHelpLayout & layout = d->helpLayout();
+  int width = d->helpWidth > 0 ? d->helpWidth : terminalWidth();
+  /* Labels wider than half the screen get their description on the next line */
+  int column = 2 + qMin(layout.labelWidth, qMax(width / 2 - 4, 0)) + 2;
+
+  if (logo)
+    out << version() << QLatin1String("\n");
+  out << QLatin1String("Usage:\n   ");
+  /* Executable name */
+  if (d->arguments().count())
+    out << QFileInfo(d->arguments().at(0)).baseName();
+  else
+    out << QCoreApplication::applicationName();
+  out << QLatin1String(" [switchs] [options]");
+  /* Arguments, short */
+  foreach (QCommandLineConfigEntry entry, d->config) {
+    if (entry.type == QCommandLineCore::Option) {
+      if (entry.flags & QCommandLineCore::Mandatory)
+	out << QLatin1String(" --") << entry.longName << QLatin1String("=<val>");
+    }
+    if (entry.type == QCommandLineCore::Range) {
+      if (entry.flags & QCommandLineCore::Mandatory)
+	out << QLatin1String(" --") << entry.longName << QLatin1String("=<range>");
+    }
+    if (entry.type == QCommandLineCore::Param) {
+      out << QLatin1String(" ");
+      if (entry.flags & QCommandLineCore::Optional)
+	out << QLatin1String("[");
+      out << entry.longName;
+      if (entry.flags & QCommandLineCore::Multiple)
+	out << QLatin1String(" [") << entry.longName << QLatin1String(" [...]]");
+      if (entry.flags & QCommandLineCore::Optional)
+	out << QLatin1String("]");
+    }
+  }
+  out << QLatin1String("\n\n");
+
+  out << QLatin1String("Options:\n");
+
+  for (int i = 0; i < d->config.size(); ++i) {
+    const QCommandLineConfigEntry & entry = d->config.at(i);
+    const QString & label = layout.labels.at(i);
+
+    if (entry.type == QCommandLineCore::Section) {
+      out << QLatin1String("\n") << entry.longName << QLatin1String(":\n");
+      continue;
+    }
+
+    out << QLatin1String("  ") << label;
+    if (2 + label.size() + 2 > column) {
+      out << '\n';
+      pad(out, column);
+    } else {
+      pad(out, column - 2 - label.size());
+    }
+    writeWrapped(out, description(entry), column, width);
+  }
+
+  out << QCoreApplication::translate("QCommandLine", "\nMandatory arguments to long options are mandatory for short options too.\n");
+}
+
+QString
+QCommandLineCore::version()
+{
+  QString v;
+
+  v = QCoreApplication::applicationName() + QLatin1Char(' ');
+  v += QCoreApplication::applicationVersion();
+  if (!QCoreApplication::organizationDomain().isEmpty()
+      || !QCoreApplication::organizationName().isEmpty())
+    v = v + QLatin1String(" - ") +
+      QCoreApplication::organizationDomain() + QLatin1String(" ") +
+      QCoreApplication::organizationDomain();
+  return v + QLatin1Char('\n');
+}
+
+void
+QCommandLineCore::showHelp(bool quit, int returnCode)
+{
+  QTextStream err(stderr);
+
+  writeHelp(err);
+  err.flush();
+  if (quit) {
+    // Can't call QApplication::exit() here, because we may be called before app.exec()
+    exit(returnCode);
+  }
+}
+
+void
+QCommandLineCore::showVersion(bool quit, int returnCode)
+{
+  QTextStream err(stderr);
+
+  err << version();
+  err.flush();
+  if (quit) {
+    exit(returnCode);
+  }
+}
@@ -0,0 +1,712 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef QCOMMAND_LINE_CORE_H
+# define QCOMMAND_LINE_CORE_H
+
+#include <QtCore/QList>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <stdio.h>
+
+#ifndef QCOMMANDLINECORE_EXPORT
+# ifndef QCOMMANDLINE_STATIC
+#  if defined(QCOMMANDLINECORE_MAKEDLL)
+    /* We are building this library */
+#   define QCOMMANDLINECORE_EXPORT Q_DECL_EXPORT
+#  else
+    /* We are using this library */
+#   define QCOMMANDLINECORE_EXPORT Q_DECL_IMPORT
+#  endif
+# endif
+#endif
+#ifndef QCOMMANDLINECORE_EXPORT
+# define QCOMMANDLINECORE_EXPORT
+#endif
+
+struct QCommandLineConfigEntry;
+typedef QList< QCommandLineConfigEntry > QCommandLineConfig;
+
+class QCommandLineArguments;
+class QCommandLineCorePrivate;
+class QCommandLineSpec;
+class QCommandLineRange;
+class QTextStream;
+
+/**
+ * Use this macro to mark the end of a QCommandLineConfigEntry array
+ */
+#define QCOMMANDLINE_CONFIG_ENTRY_END      \
+    { QCommandLineCore::None, '\0', NULL, NULL, QCommandLineCore::Default }
+
+/**
+ * @brief A parse error, translated and formatted only when needed
+ */
+struct QCOMMANDLINECORE_EXPORT QCommandLineError {
+    /**
+     * QCommandLineError constructor
+     * @param message Untranslated message
+     * @param args Arguments of the message
+     */
+    QCommandLineError(const char *message = 0, const QStringList & args = QStringList());
+
+    /**
+     * Untranslated message, marked with QT_TRANSLATE_NOOP("QCommandLine", ...)
+     */
+    const char *message;
+    /**
+     * Replace %1, %2... in the message
+     */
+    QStringList args;
+
+    /**
+     * @returns the translated message, with its arguments
+     */
+    QString toString() const;
+};
+
+/**
+ * @brief Receive the entries found by QCommandLineCore::parse()
+ *
+ * Default implementations do nothing, reimplement the ones you need.
+ */
+class QCOMMANDLINECORE_EXPORT QCommandLineHandler
+{
+public:
+    virtual ~QCommandLineHandler();
+
+    /**
+     * Called when a switch is found while parsing
+     * @param id The id of the switch.
+     * @param name The "longName" of the switch.
+     * @sa QCommandLineCore::entryId
+     */
+    virtual void switchFound(int id, const QString & name);
+
+    /**
+     * Called when an option is found while parsing
+     * @param id The id of the option.
+     * @param name The "longName" of the option.
+     * @param value The value of that option
+     * @sa QCommandLineCore::entryId
+     */
+    virtual void optionFound(int id, const QString & name, const QString & value);
+
+    /**
+     * Called when a param is found while parsing
+     * @param id The id of the param.
+     * @param name The "longName" of the param.
+     * @param value The actual argument
+     * @sa QCommandLineCore::entryId
+     */
+    virtual void paramFound(int id, const QString & name, const QString & value);
+
+    /**
+     * Called when a Range option is found while parsing, once with all
+     * the values given to it. The default implementation calls
+     * optionFound() with the set written like "1,5-9,12".
+     * @param id The id of the option.
+     * @param name The "longName" of the option.
+     * @param range The values of that option
+     * @sa QCommandLineCore::entryId
+     */
+    virtual void rangeFound(int id, const QString & name, const QCommandLineRange & range);
+
+    /**
+     * Called when a parse error is detected, parsing stops right after.
+     * The default implementation calls parseError() with the formatted
+     * error, reimplement it to skip the translation when the message is
+     * not shown.
+     * @param error Parse error
+     */
+    virtual void errorFound(const QCommandLineError & error);
+
+    /**
+     * Called by errorFound() when a parse error is detected.
+     * @param error Parse error description
+     */
+    virtual void parseError(const QString & error);
+};
+
+/**
+ * @brief A single entry found by QCommandLineCore::parse()
+ */
+struct QCommandLineEvent {
+    /**
+     * Event kind
+     */
+    typedef enum {
+	Switch,
+	Option,
+	Param,
+	Error
+    } Kind;
+
+    Kind kind;
+    /**
+     * The id of the entry, QCommandLineCore::InvalidId for errors
+     */
+    int id;
+    /**
+     * The "longName" of the entry, empty for errors
+     */
+    QString name;
+    /**
+     * The option or param value, or the error description
+     */
+    QString value;
+};
+
+/**
+ * @brief QCommandLineHandler that records every event in a plain list
+ */
+class QCOMMANDLINECORE_EXPORT QCommandLineResult : public QCommandLineHandler
+{
+public:
+    virtual void switchFound(int id, const QString & name);
+    virtual void optionFound(int id, const QString & name, const QString & value);
+    virtual void paramFound(int id, const QString & name, const QString & value);
+    virtual void parseError(const QString & error);
+
+    /**
+     * @returns how many times the switch @p name was found
+     */
+    int switchCount(const QString & name) const;
+
+    /**
+     * @returns how many times the switch with the given @p id was found
+     */
+    int switchCount(int id) const;
+
+    /**
+     * @returns the values found for option or param @p name, in order
+     */
+    QStringList values(const QString & name) const;
+
+    /**
+     * @returns the values found for the option or param with the given @p id, in order
+     */
+    QStringList values(int id) const;
+
+    /**
+     * @returns the parse error, or an empty string if there was none
+     */
+    QString errorString() const;
+
+    /**
+     * Events, in the order they were produced
+     */
+    QList< QCommandLineEvent > events;
+};
+
+/**
+ * @brief Checks applied to the values of an option or param
+ *
+ * Values are checked while parsing, an invalid one is reported through
+ * QCommandLineHandler::parseError() with its argument index.
+ * @sa QCommandLineCore::setValidator
+ */
+struct QCommandLineValidator {
+    /**
+     * Checks, can be combined
+     */
+    typedef enum {
+	None = 0, /**< no check */
+	Exists = 0x01, /**< the value is an existing path */
+	File = 0x02, /**< the value is an existing file */
+	Dir = 0x04, /**< the value is an existing directory */
+	Readable = 0x08, /**< the value is a readable path */
+	Pattern = 0x10, /**< the whole value matches pattern, a QRegExp */
+	Number = 0x20 /**< the value is a number between min and max */
+    } Check;
+
+    /**
+     * QCommandLineValidator constructor
+     * @param checks The Check values to apply
+     * @param pattern The regular expression used by Pattern
+     * @param min The smallest value accepted by Number
+     * @param max The largest value accepted by Number
+     */
+    QCommandLineValidator(int checks = None, const QString & pattern = QString(),
+			  double min = 0, double max = 0)
+      : checks(checks), pattern(pattern), min(min), max(max) {}
+
+    int checks;
+    QString pattern;
+    double min;
+    double max;
+};
+
+/**
+ * @brief Command line parser without QObject
+ *
+ * This class does not depend on moc and never creates a QObject, results
+ * are given to a QCommandLineHandler. QCommandLine is a thin wrapper
+ * around it that turns them into signals.
+ */
+class QCOMMANDLINECORE_EXPORT QCommandLineCore
+{
+public:
+    /**
+     * Enum used to determine entry type in QCommandLineConfigEntry
+     */
+    typedef enum {
+	None = 0, /**< can be used for the last line of a QCommandLineConfigEntry[] . */
+	Switch, /**< a simple switch wihout argument (eg: ls -l) */
+	Option, /**< an option with an argument (eg: tar -f test.tar) */
+	Param, /**< a parameter without '-' delimiter (eg: cp foo bar) */
+	Section, /**< starts a new group of entries in help, longName is the title */
+	Range /**< an option whose value is a set of integers (eg: --shard=0-99,200-299), see QCommandLineRange */
+    } Type;
+
+    /**
+     * Flags that can be applied to a QCommandLineConfigEntry
+     */
+    typedef enum {
+	Default = 0, /**< can be used for the last line of a QCommandLineConfigEntry[] . */
+	Mandatory = 0x01, /**< mandatory argument, will produce a parse error if not present */
+	Optional = 0x02, /**< optional argument */
+	Multiple = 0x04, /**< argument can be used multiple time and will produce multiple signals. */
+	Stream = 0x08, /**< Multiple param read from the input stream when given as '-' (eg: find -print0 | xargs -0) */
+	Glob = 0x10, /**< Multiple param whose wildcards ('*', '?', '[...]', '**') are expanded by the parser, directories walked in parallel and matches reported sorted as soon as known */
+	Unique = 0x20, /**< Multiple param or option reporting each value once, where it first appeared */
+	MandatoryMultiple = Mandatory|Multiple,
+	OptionalMultiple = Optional|Multiple,
+    } Flags;
+
+    /**
+     * Special entry ids
+     * @sa entryId
+     */
+    typedef enum {
+	InvalidId = -1, /**< no such entry */
+	HelpId = -2, /**< the --help switch */
+	VersionId = -3 /**< the --version switch */
+    } Id;
+
+    /**
+     * QCommandLineCore constructor
+     * No arguments, no configuration, help and version are disabled.
+     */
+    QCommandLineCore();
+
+    /**
+     * QCommandLineCore constructor
+     * @param argc Size of the argv array
+     * @param argv Argument array
+     * @param config The parser config
+     * @sa setArguments
+     * @sa setConfig
+     */
+    QCommandLineCore(int argc, char *argv[],
+		     const QCommandLineConfig & config = QCommandLineConfig());
+
+    /**
+     * QCommandLineCore constructor
+     * @param args Command line arguments
+     * @param config The parser config
+     * @sa setArguments
+     * @sa setConfig
+     */
+    QCommandLineCore(const QStringList args,
+		     const QCommandLineConfig & config = QCommandLineConfig());
+
+    /**
+     * QCommandLineCore destructor
+     */
+    virtual ~QCommandLineCore();
+
+    /**
+     * Set the parser configuration
+     * @param config The configuration
+     * @sa config
+     */
+    void setConfig(const QCommandLineConfig & config);
+
+    /**
+     * Set the parser configuration
+     * @param config An array containing the configuration
+     * @sa config
+     */
+    void setConfig(const QCommandLineConfigEntry config[]);
+
+    /**
+     * Get the current parser configuration
+     * @returns The parser configuration
+     * @sa setConfig
+     */
+    QCommandLineConfig config();
+
+    /**
+     * Set command line arguments
+     * @param argc Size of the argv array
+     * @param argv Array of arguments
+     * @sa arguments
+     */
+    void setArguments(int argc, char *argv[]);
+
+    /**
+     * Set command line arguments
+     * @param args A list of arguments
+     * @sa arguments
+     */
+    void setArguments(const QStringList & args);
+
+    /**
+     * Get command line arguments
+     * @returns Command line arguments (like QApplication::arguments())
+     * @sa arguments
+     */
+    QStringList arguments() const;
+
+    /**
+     * Enable --help,-h switch
+     * @param enable true to enable, false to disable
+     * @sa enableHelp
+     */
+    void enableHelp(bool enable);
+
+    /**
+     * Check if help is enabled or not.
+     * @returns true if help is enabled; otherwise returns false.
+     * @sa enableVersion
+     */
+    bool helpEnabled() const;
+
+    /**
+     * Enable --version,-V switch
+     * @param enable true to enable, false to disable
+     * @sa versionEnabled
+     */
+    void enableVersion(bool enable);
+
+    /**
+     * Check if version is enabled or not.
+     * @returns true if version is enabled; otherwise returns false.
+     * @sa enableHelp
+     */
+    bool versionEnabled() const;
+
+    /**
+     * Enable low memory mode.
+     *
+     * In this mode setArguments(int, char **) keeps using the given argv
+     * array, which must stay valid, instead of copying it, and the
+     * parser tables are freed after each parse() instead of being kept
+     * for the next one. An argv given before, like the one given to the
+     * constructor, is not copied anymore either.
+     * @param enable true to enable, false to disable
+     * @sa peakMemoryEstimate
+     */
+    void enableLowMemory(bool enable);
+
+    /**
+     * Check if low memory mode is enabled or not.
+     * @returns true if low memory mode is enabled; otherwise returns false.
+     * @sa enableLowMemory
+     */
+    bool lowMemoryEnabled() const;
+
+    /**
+     * Get an estimate of the peak memory used by the last parse().
+     * It is computed from the sizes of the arguments, the parser tables
+     * and the values found, not measured: allocator overhead, Qt's own
+     * data and what handlers keep are not counted. Use it to compare
+     * configurations and modes, not as an exact budget.
+     * @returns The estimated peak number of bytes, 0 before the first parse()
+     * @sa enableLowMemory
+     */
+    qint64 peakMemoryEstimate() const;
+
+    /**
+     * Set where Stream params are read from.
+     *
+     * When a lone '-' is given where a Multiple param with the Stream
+     * flag is expected, records are read from @p stream by large chunks
+     * and each one is reported as a param as soon as it is read. Empty
+     * records are skipped. After a '+', a '-' is a literal param.
+     * @param stream The input stream, stdin by default
+     * @param separator The record separator, use '\0' for `find -print0`
+     */
+    void setParamStream(FILE *stream, char separator = '\n');
+
+    /**
+     * Cache parse() results on disk.
+     *
+     * Successful results are stored in @p dir, in a file named after a
+     * hash of the configuration, the validators and the arguments. The
+     * next parse() with the same ones gives the stored results to the
+     * handler instead of parsing again, as long as the files checked by
+     * validators did not change. Configurations with Stream or Glob
+     * params are never cached, their results depend on more than the
+     * arguments. When a result is stored, files of @p dir older than a
+     * month are removed, and the oldest ones beyond 256.
+     *
+     * Anyone who can write to @p dir can change the results: it must be
+     * private to the user, like a directory below $XDG_CACHE_HOME. It is
+     * created readable by its owner only, and cache files owned by
+     * others are ignored.
+     * @param dir The cache directory, created if needed, empty to disable the cache
+     * @sa cacheDir
+     */
+    void setCacheDir(const QString & dir);
+
+    /**
+     * Get the directory parse() results are cached in
+     * @returns The cache directory, empty if the cache is disabled
+     * @sa setCacheDir
+     */
+    QString cacheDir() const;
+
+    /**
+     * Parse command line and call @p handler when switchs, options, or
+     * param are found.
+     * Params are reported while parsing, switchs and options once
+     * the whole command line has been checked.
+     * @param handler The handler receiving the results
+     * @returns true if successfully parsed; otherwise returns false.
+     * @sa QCommandLineResult
+     */
+    bool parse(QCommandLineHandler & handler);
+
+    /**
+     * Parse @p args instead of the arguments of this parser, see
+     * parse(QCommandLineHandler &).
+     *
+     * This one is thread-safe: it can be called from many threads at
+     * once, while others change the configuration. Each call uses the
+     * configuration as it was when it started, without taking a lock,
+     * except the first parse after a change, which builds the tables
+     * for the new configuration, and every parse in low memory mode.
+     * It does not update peakMemoryEstimate().
+     * @param args Command line arguments, starting with the program name
+     * @param handler The handler receiving the results
+     * @returns true if successfully parsed; otherwise returns false.
+     */
+    bool parse(const QStringList & args, QCommandLineHandler & handler);
+
+    /**
+     * Define a new option
+     * @param shortName Short name for this option (ex: h)
+     * @param longName Long name for this option (ex: help)
+     * @param descr Help text
+     * @param flags Switch flags
+     * @returns The id of this option
+     * @sa addSwitch
+     * @sa addParam
+     */
+    int addOption(const QChar & shortName,
+		   const QString & longName = QString(),
+		   const QString & descr = QString(),
+		   QCommandLineCore::Flags flags = QCommandLineCore::Optional);
+
+    /**
+     * Define a new switch
+     * @param shortName Short name for this switch (ex: h)
+     * @param longName Long name for this switch (ex: help)
+     * @param descr Help text
+     * @param flags Parameter flags
+     * @returns The id of this switch
+     * @sa addOption
+     * @sa addParam
+     */
+    int addSwitch(const QChar & shortName,
+		   const QString & longName = QString(),
+		   const QString & descr = QString(),
+		   QCommandLineCore::Flags flags = QCommandLineCore::Optional);
+
+    /**
+     * Define a new parameter
+     * @param name Name, used in help, usage and error messages
+     * @param descr Help text
+     * @param flags Parameter flags
+     * @returns The id of this parameter
+     * @sa addSwitch
+     * @sa addOption
+     */
+    int addParam(const QString & name,
+		  const QString & descr = QString(),
+		  QCommandLineCore::Flags flags = QCommandLineCore::Optional);
+
+    /**
+     * Start a new section, entries defined after it are grouped
+     * under @p title in the help message.
+     * @param title Section title
+     * @returns The id of this section
+     * @sa help
+     */
+    int addSection(const QString & title);
+
+    /**
+     * Remove any option of type QCommandLine::Option with a given shortName or longName.
+     * @param name the name of the option to remove
+     * @sa removeParam
+     * @sa removeSwitch
+     */
+    void removeOption(const QString & name);
+
+    /**
+     * Remove any option of type QCommandLine::Switch with a given shortName or longName.
+     * @param name the name of the option to remove
+     * @sa removeOption
+     * @sa removeParam
+     */
+    void removeSwitch(const QString & name);
+
+    /**
+     * Remove any option of type QCommandLine::Param with a given shortName or longName.
+     * @param name the name of the option to remove
+     * @sa removeOption
+     * @sa removeSwitch
+     */
+    void removeParam(const QString & name);
+
+    /**
+     * Get the id of an entry.
+     *
+     * Ids are reported with every switch, option and param found, so
+     * that they can be dispatched with a switch statement or used as
+     * an array index instead of comparing names. Entries given
+     * to setConfig() get their index as id, entries added later the
+     * next free one; ids do not change when other entries are removed.
+     * Entries sharing a longName are all reported with the id of the
+     * first one.
+     * @param name The "longName" of the entry
+     * @returns The entry id, HelpId, VersionId, or InvalidId if there is no such entry
+     * @sa addOption
+     * @sa setConfig
+     */
+    int entryId(const QString & name) const;
+
+    /**
+     * Check the values of an option or param.
+     *
+     * Pattern and Number are checked when the value is found. Exists,
+     * File, Dir and Readable need the filesystem: values are checked
+     * by batches on QtConcurrent's thread pool, params waiting for their
+     * batch are reported once it has been checked, still in order.
+     * A validator whose pattern is not a valid QRegExp is ignored with a
+     * warning, the previous one is kept.
+     * @param name The "longName" of the entries to check
+     * @param validator The checks, QCommandLineValidator() to remove them
+     */
+    void setValidator(const QString & name, const QCommandLineValidator & validator);
+
+    /**
+     * Return the help message
+     * @param logo also show version message on top of the help message, off by default
+     * @sa version
+     */
+    QString help(bool logo = false);
+
+    /**
+     * Write the help message to a stream, without building it in memory first
+     * @param out The output stream
+     * @param logo also show version message on top of the help message, off by default
+     * @sa help
+     */
+    void writeHelp(QTextStream & out, bool logo = false);
+
+    /**
+     * Set the width descriptions are wrapped to in the help message
+     * @param columns Width in columns, 0 to use the terminal width
+     * @sa helpWidth
+     */
+    void setHelpWidth(int columns);
+
+    /**
+     * Get the width descriptions are wrapped to in the help message
+     * @returns Width in columns, 0 if the terminal width is used
+     * @sa setHelpWidth
+     */
+    int helpWidth() const;
+
+    /**
+     * Return the version message
+     * @sa help
+     */
+    QString version();
+
+    /**
+     * Show the help message.
+     * @param exit Exit if true
+     * @param returnCode return code of the program if exit is true
+     * @sa showVersion
+     */
+    void showHelp(bool exit = true, int returnCode = 0);
+
+    /**
+     * Show the version message.
+     * @param exit Exit if true
+     * @param returnCode return code of the program if exit is true
+     * @sa showHelp
+     */
+    void showVersion(bool exit = true, int returnCode = 0);
+
+    /**
+     * Standard --help, -h entry
+     */
+    static const QCommandLineConfigEntry helpEntry;
+
+    /**
+     * Standard --version, -V entry
+     */
+    static const QCommandLineConfigEntry versionEntry;
+
+private:
+    friend class QCommandLine;
+    friend class QCommandLineSession;
+
+    bool parseArguments(const QCommandLineArguments & args,
+			QCommandLineHandler & handler, qint64 & peakMemory);
+    bool parseArguments(const QCommandLineSpec & spec, const QCommandLineArguments & args,
+			QCommandLineHandler & handler, qint64 & peakMemory);
+
+    Q_DISABLE_COPY(QCommandLineCore)
+    QCommandLineCorePrivate *d;
+};
+
+/**
+ * @brief Configuration entry structure
+ */
+struct QCommandLineConfigEntry {
+    /**
+     * Entry Type
+     */
+    QCommandLineCore::Type type;
+    /**
+     * Short Name
+     */
+    QChar shortName;
+    /**
+     * Long Name
+     */
+    QString longName;
+    /**
+     * Description, used in --help, translated in the "QCommandLine"
+     * context when shown (see QT_TRANSLATE_NOOP)
+     */
+    QString descr;
+    /**
+     * Option flags
+     */
+    QCommandLineCore::Flags flags;
+};
+
+#endif
@@ -0,0 +1,168 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef QCOMMAND_LINE_CORE_P_H
+# define QCOMMAND_LINE_CORE_P_H
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QAtomicPointer>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QRegExp>
+#include <QtCore/QVector>
+#include <stdio.h>
+
+#include "qcommandlinecore.h"
+
+/*
+ * Value of the name tables: the slot of the entry, and whether this
+ * copy of a Mandatory entry has already been found.
+ */
+struct QCommandLineKey {
+    int slot;
+    bool found;
+};
+
+/*
+ * Help layout, computed once from the configuration and rebuilt
+ * lazily after it changed.
+ */
+class QCommandLineHelpLayout {
+public:
+    QStringList labels; /* help label of each config entry */
+    int labelWidth; /* widest label */
+};
+
+/*
+ * Parser tables, computed from a copy of the configuration and never
+ * changed once published: a new spec replaces them after the
+ * configuration changed.
+ *
+ * The parser refers to entries by slot: config entries except sections,
+ * then the help and version entries when enabled. Slots point to the
+ * entries, they are never copied. Entries sharing a longName are
+ * interned to the same name, reported with the id of the first of them.
+ */
+class QCommandLineSpec {
+public:
+    QCommandLineConfig config; /* the configuration it was built from */
+    int generation; /* of the configuration it was built from */
+    QAtomicInt ref; /* the published pointer, and each parser using it */
+    QVector< const QCommandLineConfigEntry * > entries; /* entry of each slot */
+    QVector< int > names; /* interned longName of each slot */
+    QVector< int > nameIds; /* id reported for each interned name */
+    QStringList nameStrings; /* longName of each interned name */
+    QHash< QString, QCommandLineKey > shortKeys;
+    QHash< QString, QCommandLineKey > longKeys;
+    QVector< int > params; /* Param slots, in order */
+    QVector< QCommandLineValidator > validators; /* checks of each slot */
+    QVector< QRegExp > patterns; /* compiled Pattern of each slot */
+    qint64 bytes; /* rough memory used by the tables */
+};
+
+/* Arguments of a parse(): a list, or argv used as is in low memory mode */
+class QCommandLineArguments {
+public:
+    QCommandLineArguments(const QStringList & list)
+      : list(&list), argc(0), argv(0), untrusted(false) {}
+    QCommandLineArguments(int argc, char **argv)
+      : list(0), argc(argc), argv(argv), untrusted(false) {}
+
+    int count() const { return list ? list->size() : argc; }
+    QString at(int i) const { return list ? list->at(i) : QString(QLatin1String(argv[i])); }
+
+    const QStringList *list;
+    int argc;
+    char **argv;
+    /* From another process (QCommandLine::reparse): params are not read
+       from the input stream, expanded, checked on the filesystem or
+       required */
+    bool untrusted;
+};
+
+/*
+ * The configuration is changed by writers holding writeLock, which only
+ * mark the published spec dirty: the first parse after a change builds
+ * and publishes a new one, under writeLock, so that many changes in a
+ * row cost a single build. Other parsers never lock: they load the
+ * published spec and reference it, and the last one to release a
+ * replaced spec frees it.
+ *
+ * Loading and referencing are two steps: parsers count themselves in
+ * loading around them, and publish() waits for it to drop to zero after
+ * replacing a spec, before dropping the reference of the published
+ * pointer. A parser which loaded the old spec has referenced it by then.
+ * The wait is over a few instructions, never a parse.
+ *
+ * In low memory mode nothing is published, each parse builds its own
+ * spec under writeLock and frees it when done.
+ */
+class QCommandLineCorePrivate {
+public:
+    QCommandLineCorePrivate();
+    ~QCommandLineCorePrivate();
+
+    bool version;
+    bool help;
+    bool lowMemory;
+    int helpWidth;
+    QStringList args;
+    /* In low memory mode, argv is used as is instead of args */
+    int argc;
+    char **argv;
+    /* Given to setArguments(int, char **), 0 for a list */
+    int sourceArgc;
+    char **sourceArgv;
+    /* Where Stream params are read from */
+    FILE *stream;
+    char separator;
+    QString cacheDir; /* where results are cached, empty if they are not */
+    QCommandLineConfig config;
+    QList< int > ids; /* id of each config entry */
+    int nextId;
+    QHash< QString, QCommandLineValidator > validators; /* by longName */
+
+    QMutex writeLock;
+    QAtomicPointer< QCommandLineSpec > published; /* 0 in low memory mode */
+    QAtomicInt loading; /* parsers between loading and referencing published */
+    QAtomicInt dirty; /* the configuration changed since published was built */
+    int generation; /* bumped by invalidate(), each configuration change */
+    bool helpDirty;
+    QHash< QString, int > shortNames; /* count of the entries using each shortName */
+    QCommandLineHelpLayout layout;
+
+    qint64 peakMemory;
+
+    /* Called by parsers */
+    const QCommandLineSpec * acquire();
+    void release(const QCommandLineSpec *spec);
+
+    /* Called with writeLock held */
+    QCommandLineSpec * build();
+    const QCommandLineHelpLayout & helpLayout();
+    void publish(QCommandLineSpec *spec);
+    void invalidate();
+    int add(const QCommandLineConfigEntry & entry);
+    void removeAt(int i);
+    void clear();
+
+    QCommandLineArguments arguments() const;
+};
+
+#endif
@@ -0,0 +1,423 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#include <QtCore/QMutex>
+#include <QtCore/QPair>
+#include <QtCore/QQueue>
+#include <QtCore/QRegExp>
+#include <QtCore/QWaitCondition>
+#ifndef QT_NO_CONCURRENT
+# include <QtCore/QRunnable>
+# include <QtCore/QThread>
+# include <QtCore/QThreadPool>
+#endif
+
+#include "qcommandlineglob_p.h"
+
+static bool
+isWildcard(const QString & segment)
+{
+  return segment.contains(QLatin1Char('*')) ||
+    segment.contains(QLatin1Char('?')) ||
+    segment.contains(QLatin1Char('['));
+}
+
+static QString
+childPath(const QString & dir, const QString & name)
+{
+  if (dir.isEmpty())
+    return name;
+  if (dir.endsWith(QLatin1Char('/')))
+    return dir + name;
+  return dir + QLatin1Char('/') + name;
+}
+
+/* Names in dir matching segment, sorted */
+static QStringList
+entries(const QString & dir, const QString & segment, bool dirsOnly, bool noSymLinks)
+{
+  QDir::Filters filters = QDir::NoDotAndDotDot | QDir::System;
+  QRegExp rx(segment, Qt::CaseSensitive, QRegExp::Wildcard);
+  QStringList matches;
+
+  filters |= dirsOnly ? QDir::Dirs : QDir::AllEntries;
+  /* Like shells, hidden files only match patterns starting with a '.' */
+  if (segment.startsWith(QLatin1Char('.')))
+    filters |= QDir::Hidden;
+  if (noSymLinks)
+    filters |= QDir::NoSymLinks;
+
+  foreach (const QString & name,
+	   QDir(dir.isEmpty() ? QString(QLatin1String(".")) : dir).entryList(filters, QDir::Name))
+    if (rx.exactMatch(name))
+      matches << name;
+  return matches;
+}
+
+typedef QList< QPair< QString, int > > QCommandLineGlobWork;
+
+/* Directories a listing can have before its walk is split in chunks */
+static const int chunkSize = 64;
+/* Matches a task can get ahead of the reporter before it waits */
+static const int queueSize = 1024;
+
+/* Where a walk reports its matches, and hands over large listings */
+class QCommandLineGlobSink {
+public:
+    virtual ~QCommandLineGlobSink() {}
+
+    virtual void found(const QString & path) = 0;
+    /* Walk each chunk in a task, their matches come next, in order */
+    virtual void split(const QList< QCommandLineGlobWork > & chunks) = 0;
+};
+
+static void match(const QString & path, const QStringList & segments, int index,
+		  QCommandLineGlobSink & sink);
+
+/* Walk the directories names below path, in chunks when there are many */
+static void
+walk(const QString & path, const QStringList & names, int index,
+     const QStringList & segments, QCommandLineGlobSink & sink)
+{
+  if (names.size() <= chunkSize) {
+    foreach (const QString & name, names)
+      match(childPath(path, name), segments, index, sink);
+    return ;
+  }
+
+  QList< QCommandLineGlobWork > chunks;
+
+  for (int i = 0; i < names.size(); i += chunkSize) {
+    QCommandLineGlobWork chunk;
+
+    for (int j = i; j < qMin(i + chunkSize, names.size()); ++j)
+      chunk << qMakePair(childPath(path, names.at(j)), index);
+    chunks << chunk;
+  }
+  sink.split(chunks);
+}
+
+static void
+match(const QString & path, const QStringList & segments, int index, QCommandLineGlobSink & sink)
+{
+  if (index == segments.size()) {
+    sink.found(path);
+    return ;
+  }
+
+  const QString & segment = segments.at(index);
+  bool last = index + 1 == segments.size();
+
+  if (segment == QLatin1String("**")) {
+    match(path, segments, index + 1, sink);
+    /* Don't follow links, they could make loops */
+    walk(path, entries(path, QLatin1String("*"), true, true), index, segments, sink);
+  } else if (!isWildcard(segment)) {
+    QString child = childPath(path, segment);
+    QFileInfo info(child);
+
+    if (last ? info.exists() : info.isDir())
+      match(child, segments, index + 1, sink);
+  } else if (last) {
+    foreach (const QString & name, entries(path, segment, false, false))
+      sink.found(childPath(path, name));
+  } else {
+    walk(path, entries(path, segment, true, false), index + 1, segments, sink);
+  }
+}
+
+/*
+ * Some directories to walk, by a pool thread or by the reporter.
+ *
+ * Whoever claims the task first walks it. A pool thread queues its
+ * matches, and the tasks of the listings it splits, for the reporter,
+ * which reports them in order. The queue is bounded: a task far ahead
+ * of the reporter waits instead of piling up matches. The reporter
+ * never waits for a task nobody runs, it claims and walks it itself.
+ */
+class QCommandLineGlobTask
+#ifndef QT_NO_CONCURRENT
+  : public QRunnable
+#endif
+{
+public:
+    /* A match, or the task whose matches come at that point */
+    struct Item {
+	QString path;
+	QCommandLineGlobTask *task;
+    };
+
+    QCommandLineGlobTask(const QCommandLineGlobWork & work, const QStringList & segments);
+
+    bool claim();
+    void walk(QCommandLineGlobSink & sink);
+    void push(const Item & item);
+    /* Next item of a task walked by a pool thread, false after the last one */
+    bool take(Item & item);
+    void release();
+
+    void run();
+
+    const QStringList segments;
+
+private:
+    QCommandLineGlobWork work;
+    QAtomicInt claimed;
+    QAtomicInt ref; /* the reporter, and the pool until it ran the task */
+    QMutex lock;
+    QWaitCondition changed;
+    QQueue< Item > items;
+    bool done;
+};
+
+/* Tasks walking chunks, queued on the thread pool */
+static QList< QCommandLineGlobTask * >
+start(const QList< QCommandLineGlobWork > & chunks, const QStringList & segments)
+{
+  QList< QCommandLineGlobTask * > tasks;
+
+  foreach (const QCommandLineGlobWork & chunk, chunks) {
+    QCommandLineGlobTask *task = new QCommandLineGlobTask(chunk, segments);
+
+#ifndef QT_NO_CONCURRENT
+    QThreadPool::globalInstance()->start(task);
+#endif
+    tasks << task;
+  }
+  return tasks;
+}
+
+/* Queues the matches of a task walked by a pool thread */
+class QCommandLineGlobQueue : public QCommandLineGlobSink {
+public:
+    QCommandLineGlobQueue(QCommandLineGlobTask & task)
+      : task(task)
+    {
+    }
+
+    void found(const QString & path)
+    {
+      QCommandLineGlobTask::Item item;
+
+      item.path = path;
+      item.task = 0;
+      task.push(item);
+    }
+
+    void split(const QList< QCommandLineGlobWork > & chunks)
+    {
+      QCommandLineGlobTask::Item item;
+
+      foreach (QCommandLineGlobTask *chunk, start(chunks, task.segments)) {
+	item.task = chunk;
+	task.push(item);
+      }
+    }
+
+private:
+    QCommandLineGlobTask & task;
+};
+
+QCommandLineGlobTask::QCommandLineGlobTask(const QCommandLineGlobWork & work,
+					   const QStringList & segments)
+  : segments(segments), work(work), claimed(0), ref(1), done(false)
+{
+#ifndef QT_NO_CONCURRENT
+  setAutoDelete(false);
+  ref.ref();
+#endif
+}
+
+bool
+QCommandLineGlobTask::claim()
+{
+  return claimed.testAndSetOrdered(0, 1);
+}
+
+void
+QCommandLineGlobTask::walk(QCommandLineGlobSink & sink)
+{
+  for (int i = 0; i < work.size(); ++i)
+    match(work.at(i).first, segments, work.at(i).second, sink);
+}
+
+void
+QCommandLineGlobTask::push(const Item & item)
+{
+  QMutexLocker locker(&lock);
+
+  while (items.size() >= queueSize)
+    changed.wait(&lock);
+  items.enqueue(item);
+  changed.wakeAll();
+}
+
+bool
+QCommandLineGlobTask::take(Item & item)
+{
+  QMutexLocker locker(&lock);
+
+  while (items.isEmpty() && !done)
+    changed.wait(&lock);
+  if (items.isEmpty())
+    return false;
+
+  item = items.dequeue();
+  changed.wakeAll();
+  return true;
+}
+
+void
+QCommandLineGlobTask::release()
+{
+  if (!ref.deref())
+    delete this;
+}
+
+void
+QCommandLineGlobTask::run()
+{
+  if (claim()) {
+    QCommandLineGlobQueue queue(*this);
+
+    walk(queue);
+
+    QMutexLocker locker(&lock);
+
+    done = true;
+    changed.wakeAll();
+  }
+  release();
+}
+
+/* Gives the matches to the handler, in order, in the parsing thread */
+class QCommandLineGlobReporter : public QCommandLineGlobSink {
+public:
+    QCommandLineGlobReporter(const QStringList & segments, QCommandLineHandler & handler,
+			     int id, const QString & name)
+      : count(0), segments(segments), handler(handler), id(id), name(name)
+    {
+    }
+
+    void found(const QString & path)
+    {
+      handler.paramFound(id, name, path);
+      count++;
+    }
+
+    void split(const QList< QCommandLineGlobWork > & chunks)
+    {
+      foreach (QCommandLineGlobTask *task, start(chunks, segments))
+	report(task);
+    }
+
+    int count;
+
+private:
+    void report(QCommandLineGlobTask *task)
+    {
+      QCommandLineGlobTask::Item item;
+
+      if (task->claim()) {
+	task->walk(*this);
+      } else {
+	while (task->take(item)) {
+	  if (item.task)
+	    report(item.task);
+	  else
+	    found(item.path);
+	}
+      }
+      task->release();
+    }
+
+    QStringList segments;
+    QCommandLineHandler & handler;
+    int id;
+    QString name;
+};
+
+bool
+QCommandLineGlob::hasWildcards(const QString & pattern)
+{
+  return isWildcard(pattern);
+}
+
+int
+QCommandLineGlob::expand(const QString & pattern, QCommandLineHandler & handler,
+			 int id, const QString & name)
+{
+  QStringList segments = pattern.split(QLatin1Char('/'), QString::SkipEmptyParts);
+  QString base = pattern.startsWith(QLatin1Char('/')) ? QString(QLatin1String("/")) : QString();
+  /* Directories left to walk, and the segment they start at */
+  QCommandLineGlobWork work;
+  int index = 0;
+
+  /* A trailing '**' matches everything below */
+  if (!segments.isEmpty() && segments.last() == QLatin1String("**"))
+    segments << QLatin1String("*");
+  /* '**' after '**' would only report every match twice */
+  for (int i = segments.size() - 1; i > 0; --i)
+    if (segments.at(i) == QLatin1String("**") && segments.at(i - 1) == QLatin1String("**"))
+      segments.removeAt(i);
+
+  while (index < segments.size() && !isWildcard(segments.at(index)))
+    base = childPath(base, segments.at(index++));
+  if (index == segments.size())
+    return 0;
+
+  QCommandLineGlobReporter reporter(segments, handler, id, name);
+
+  /* Wildcard in the last segment (eg: logs/*.gz): nothing left to walk */
+  if (index + 1 == segments.size()) {
+    match(base, segments, index, reporter);
+    return reporter.count;
+  }
+
+  /* Split the walk below the first wildcard */
+  if (segments.at(index) == QLatin1String("**")) {
+    work << qMakePair(base, index + 1);
+    foreach (const QString & dir, entries(base, QLatin1String("*"), true, true))
+      work << qMakePair(childPath(base, dir), index);
+  } else {
+    foreach (const QString & entry, entries(base, segments.at(index), true, false))
+      work << qMakePair(childPath(base, entry), index + 1);
+  }
+
+  /* A few contiguous batches of directories per thread, not a task each */
+  QList< QCommandLineGlobWork > batches;
+#ifndef QT_NO_CONCURRENT
+  int count = qMin(work.size(), 4 * qMax(1, QThread::idealThreadCount()));
+#else
+  int count = qMin(work.size(), 1);
+#endif
+
+  for (int i = 0; i < count; ++i) {
+    int first = work.size() * i / count;
+    int next = work.size() * (i + 1) / count;
+
+    batches << work.mid(first, next - first);
+  }
+  reporter.split(batches);
+  return reporter.count;
+}
@@ -0,0 +1,45 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef QCOMMAND_LINE_GLOB_P_H
+# define QCOMMAND_LINE_GLOB_P_H
+
+#include "qcommandlinecore.h"
+
+/*
+ * Wildcard expansion of Glob params.
+ *
+ * Patterns use '*', '?' and '[...]' in path segments, and '**' for any
+ * number of directories. Matches are reported in a stable order, names
+ * being sorted in each directory. Matches of a wildcard in the last
+ * segment are reported directly. Otherwise the directories below the
+ * first wildcard are split in a few batches per thread, and any deeper
+ * listing of many directories in chunks, walked in parallel on the
+ * global thread pool. Their matches stream to the parsing thread
+ * through bounded queues, reported as soon as the ones before them.
+ */
+class QCommandLineGlob {
+public:
+    static bool hasWildcards(const QString & pattern);
+    /* Returns the number of matches, each reported as a param */
+    static int expand(const QString & pattern, QCommandLineHandler & handler,
+		      int id, const QString & name);
+};
+
+#endif
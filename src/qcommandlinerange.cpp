@@ -0,0 +1,216 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <QtCore/QStringList>
+#include <QtCore/QtAlgorithms>
+
+#include "qcommandlinerange.h"
+
+static bool
+intervalLessThan(const QCommandLineRange::Interval & a, const QCommandLineRange::Interval & b)
+{
+  return a.first < b.first;
+}
+
+const qint64 QCommandLineRange::MaxValue;
+
+QCommandLineRange::const_iterator::const_iterator(const QCommandLineRange *range, int interval)
+  : range(range), interval(interval), value(0)
+{
+  if (interval < range->ranges.size())
+    value = range->ranges.at(interval).first;
+}
+
+QCommandLineRange::const_iterator &
+QCommandLineRange::const_iterator::operator++()
+{
+  if (value < range->ranges.at(interval).last) {
+    value++;
+  } else {
+    interval++;
+    value = interval < range->ranges.size() ? range->ranges.at(interval).first : 0;
+  }
+  return *this;
+}
+
+QCommandLineRange::QCommandLineRange()
+{
+}
+
+QCommandLineRange
+QCommandLineRange::fromString(const QString & text, bool *ok)
+{
+  QCommandLineRange range;
+
+  if (ok)
+    *ok = true;
+
+  foreach (const QString & item, text.split(QLatin1Char(','))) {
+    int dash = item.indexOf(QLatin1Char('-'));
+    bool firstOk, lastOk = true;
+    qint64 first, last;
+
+    if (dash == -1) {
+      first = last = item.trimmed().toLongLong(&firstOk);
+    } else {
+      first = item.left(dash).trimmed().toLongLong(&firstOk);
+      last = item.mid(dash + 1).trimmed().toLongLong(&lastOk);
+    }
+
+    if (!firstOk || !lastOk || first < 0 || last < first || last > MaxValue) {
+      if (ok)
+	*ok = false;
+      return QCommandLineRange();
+    }
+
+    Interval interval = { first, last };
+
+    range.ranges << interval;
+  }
+
+  range.normalize();
+  return range;
+}
+
+/* Sort and merge the intervals */
+void
+QCommandLineRange::normalize()
+{
+  int n = 0;
+
+  qSort(ranges.begin(), ranges.end(), intervalLessThan);
+
+  for (int i = 0; i < ranges.size(); ++i) {
+    const Interval & interval = ranges.at(i);
+
+    /* Merge overlapping and adjacent intervals */
+    if (n && interval.first <= ranges.at(n - 1).last + 1)
+      ranges[n - 1].last = qMax(ranges.at(n - 1).last, interval.last);
+    else
+      ranges[n++] = interval;
+  }
+  ranges.resize(n);
+}
+
+void
+QCommandLineRange::add(qint64 first, qint64 last)
+{
+  Interval interval = { first, last };
+
+  if (first < 0 || last < first || last > MaxValue)
+    return ;
+  /* Values usually come in increasing order */
+  if (ranges.isEmpty() || first > ranges.last().last + 1) {
+    ranges << interval;
+    return ;
+  }
+  ranges << interval;
+  normalize();
+}
+
+void
+QCommandLineRange::unite(const QCommandLineRange & other)
+{
+  if (other.isEmpty())
+    return ;
+  if (isEmpty()) {
+    ranges = other.ranges;
+    return ;
+  }
+  ranges << other.ranges;
+  normalize();
+}
+
+bool
+QCommandLineRange::contains(qint64 value) const
+{
+  int lo = 0, hi = ranges.size();
+
+  /* First interval ending at or after value */
+  while (lo < hi) {
+    int mid = (lo + hi) / 2;
+
+    if (ranges.at(mid).last < value)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo < ranges.size() && ranges.at(lo).first <= value;
+}
+
+bool
+QCommandLineRange::isEmpty() const
+{
+  return ranges.isEmpty();
+}
+
+qint64
+QCommandLineRange::count() const
+{
+  qint64 count = 0;
+
+  foreach (const Interval & interval, ranges)
+    count += interval.last - interval.first + 1;
+  return count;
+}
+
+const QVector< QCommandLineRange::Interval > &
+QCommandLineRange::intervals() const
+{
+  return ranges;
+}
+
+QString
+QCommandLineRange::toString() const
+{
+  QStringList items;
+
+  foreach (const Interval & interval, ranges) {
+    if (interval.first == interval.last)
+      items << QString::number(interval.first);
+    else
+      items << QString::number(interval.first) + QLatin1Char('-') + QString::number(interval.last);
+  }
+  return items.join(QLatin1String(","));
+}
+
+QCommandLineRange::const_iterator
+QCommandLineRange::begin() const
+{
+  return const_iterator(this, 0);
+}
+
+QCommandLineRange::const_iterator
+QCommandLineRange::end() const
+{
+  return const_iterator(this, ranges.size());
+}
+
+bool
+QCommandLineRange::operator==(const QCommandLineRange & other) const
+{
+  if (ranges.size() != other.ranges.size())
+    return false;
+  for (int i = 0; i < ranges.size(); ++i)
+    if (ranges.at(i).first != other.ranges.at(i).first ||
+	ranges.at(i).last != other.ranges.at(i).last)
+      return false;
+  return true;
+}
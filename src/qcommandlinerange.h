@@ -0,0 +1,144 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef QCOMMAND_LINE_RANGE_H
+# define QCOMMAND_LINE_RANGE_H
+
+#include <QtCore/QMetaType>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+
+#include "qcommandlinecore.h"
+
+/**
+ * @brief A set of integers, stored as sorted intervals
+ *
+ * Value of QCommandLineCore::Range options, like `--shard=0-99999,200000-299999`.
+ * Only the bounds of each interval are stored: membership tests are
+ * O(log n) in the number of intervals, and values are iterated without
+ * being materialised.
+ */
+class QCOMMANDLINECORE_EXPORT QCommandLineRange
+{
+public:
+    /**
+     * Largest value a set can hold, so that counting and merging
+     * intervals never overflows
+     */
+    static const qint64 MaxValue = Q_INT64_C(0x3fffffffffffffff);
+
+    /**
+     * A closed interval of the set
+     */
+    struct Interval {
+	qint64 first;
+	qint64 last;
+    };
+
+    /**
+     * Iterate over the values of the set, in increasing order
+     */
+    class const_iterator {
+    public:
+	const_iterator() : range(0), interval(0), value(0) {}
+	const_iterator(const QCommandLineRange *range, int interval);
+
+	qint64 operator*() const { return value; }
+	const_iterator & operator++();
+	bool operator==(const const_iterator & other) const
+	{ return interval == other.interval && value == other.value; }
+	bool operator!=(const const_iterator & other) const { return !(*this == other); }
+
+    private:
+	const QCommandLineRange *range;
+	int interval;
+	qint64 value;
+    };
+
+    /**
+     * QCommandLineRange constructor, creates an empty set
+     */
+    QCommandLineRange();
+
+    /**
+     * Parse a comma separated list of values and intervals,
+     * like "1,5-9,12". Values are integers from 0 to MaxValue.
+     * @param text The list
+     * @param ok Set to false if the list is invalid, the set is then empty
+     * @returns The set
+     */
+    static QCommandLineRange fromString(const QString & text, bool *ok = 0);
+
+    /**
+     * Add the values from @p first to @p last, both included.
+     * Nothing is added unless 0 <= @p first <= @p last <= MaxValue.
+     * @param first The first value
+     * @param last The last value
+     */
+    void add(qint64 first, qint64 last);
+
+    /**
+     * Add all the values of another set
+     * @param other The other set
+     */
+    void unite(const QCommandLineRange & other);
+
+    /**
+     * @returns true if @p value is in the set
+     */
+    bool contains(qint64 value) const;
+
+    /**
+     * @returns true if the set is empty
+     */
+    bool isEmpty() const;
+
+    /**
+     * @returns the number of values in the set
+     */
+    qint64 count() const;
+
+    /**
+     * @returns the intervals of the set, sorted, disjoint and not adjacent
+     */
+    const QVector< Interval > & intervals() const;
+
+    /**
+     * @returns the set as a list like "1,5-9,12"
+     */
+    QString toString() const;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    bool operator==(const QCommandLineRange & other) const;
+    bool operator!=(const QCommandLineRange & other) const { return !(*this == other); }
+
+private:
+    friend class const_iterator;
+
+    void normalize();
+
+    QVector< Interval > ranges;
+};
+
+Q_DECLARE_METATYPE(QCommandLineRange)
+
+#endif
@@ -0,0 +1,183 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <QtCore/QHash>
+#include <QtCore/QStringList>
+#include <QtNetwork/QLocalServer>
+#include <QtNetwork/QLocalSocket>
+
+#include "qcommandlineserver.h"
+
+/* Bytes a client may send without ending its request */
+static const qint64 maxRequestSize = 64 * 1024;
+
+/* Time given to a running instance to accept the probe connection, in ms */
+static const int probeTimeout = 1000;
+
+class QCommandLineServerPrivate {
+public:
+    QCommandLineServerPrivate(QCommandLine *cmdline);
+
+    QCommandLine *cmdline;
+    QLocalServer server;
+    /* Arguments received so far from each client, and their size */
+    QHash< QLocalSocket *, QStringList > pending;
+    QHash< QLocalSocket *, qint64 > pendingSize;
+};
+
+QCommandLineServerPrivate::QCommandLineServerPrivate(QCommandLine *cmdline)
+  : cmdline(cmdline)
+{
+}
+
+QCommandLineServer::QCommandLineServer(QCommandLine * cmdline, QObject * parent)
+  : QObject(parent), d(new QCommandLineServerPrivate(cmdline))
+{
+  connect(&d->server, SIGNAL(newConnection()), this, SLOT(newConnection()));
+}
+
+QCommandLineServer::~QCommandLineServer()
+{
+  close();
+  delete d;
+}
+
+bool
+QCommandLineServer::listen(const QString & name)
+{
+  if (d->server.listen(name))
+    return true;
+
+  if (d->server.serverError() != QAbstractSocket::AddressInUseError)
+    return false;
+
+  /* A previous instance may have left its socket file behind, only
+     remove it if nothing accepts connections on it anymore */
+  QLocalSocket probe;
+
+  probe.connectToServer(name);
+  if (probe.waitForConnected(probeTimeout)) {
+    probe.disconnectFromServer();
+    return false;
+  }
+  if (probe.error() != QLocalSocket::ConnectionRefusedError)
+    return false;
+
+  QLocalServer::removeServer(name);
+  return d->server.listen(name);
+}
+
+void
+QCommandLineServer::close()
+{
+  d->server.close();
+
+  foreach (QLocalSocket *socket, d->pending.keys()) {
+    socket->disconnect(this);
+    socket->abort();
+    socket->deleteLater();
+  }
+  d->pending.clear();
+  d->pendingSize.clear();
+}
+
+bool
+QCommandLineServer::isListening() const
+{
+  return d->server.isListening();
+}
+
+QString
+QCommandLineServer::serverName() const
+{
+  return d->server.fullServerName();
+}
+
+QString
+QCommandLineServer::errorString() const
+{
+  return d->server.errorString();
+}
+
+void
+QCommandLineServer::newConnection()
+{
+  while (QLocalSocket *socket = d->server.nextPendingConnection()) {
+    d->pending.insert(socket, QStringList());
+    d->pendingSize.insert(socket, 0);
+    connect(socket, SIGNAL(readyRead()), this, SLOT(readRequest()));
+    connect(socket, SIGNAL(disconnected()), this, SLOT(dropClient()));
+  }
+}
+
+void
+QCommandLineServer::readRequest()
+{
+  QLocalSocket *socket = qobject_cast< QLocalSocket * >(sender());
+
+  if (!socket || !d->pending.contains(socket))
+    return ;
+
+  while (socket->canReadLine()) {
+    QByteArray line = socket->readLine();
+
+    d->pendingSize[socket] += line.size();
+    while (line.endsWith('\n') || line.endsWith('\r'))
+      line.chop(1);
+
+    if (!line.isEmpty()) {
+      d->pending[socket] << QString::fromUtf8(line.constData(), line.size());
+      continue;
+    }
+
+    /* An empty line ends the request */
+    QStringList args = d->pending.value(socket);
+    QStringList current = d->cmdline->arguments();
+    QString error;
+
+    args.prepend(current.isEmpty() ? QString() : current.first());
+    d->pending[socket].clear();
+    d->pendingSize[socket] = 0;
+
+    if (d->cmdline->reparse(args, &error))
+      socket->write("ok\n");
+    else
+      socket->write("error: " + error.simplified().toUtf8() + '\n');
+  }
+
+  /* Do not buffer arguments forever for a client never ending its request */
+  if (d->pendingSize.value(socket) + socket->bytesAvailable() > maxRequestSize) {
+    socket->write("error: request too large\n");
+    socket->disconnectFromServer();
+  }
+}
+
+void
+QCommandLineServer::dropClient()
+{
+  QLocalSocket *socket = qobject_cast< QLocalSocket * >(sender());
+
+  if (!socket)
+    return ;
+
+  d->pending.remove(socket);
+  d->pendingSize.remove(socket);
+  socket->deleteLater();
+}
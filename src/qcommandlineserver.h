@@ -0,0 +1,117 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef QCOMMAND_LINE_SERVER_H
+# define QCOMMAND_LINE_SERVER_H
+
+#include <QtCore/QObject>
+#include <QtCore/QString>
+
+#include "qcommandline.h"
+
+#ifndef QCOMMANDLINESERVER_EXPORT
+# ifndef QCOMMANDLINE_STATIC
+#  if defined(QCOMMANDLINESERVER_MAKEDLL)
+    /* We are building this library */
+#   define QCOMMANDLINESERVER_EXPORT Q_DECL_EXPORT
+#  else
+    /* We are using this library */
+#   define QCOMMANDLINESERVER_EXPORT Q_DECL_IMPORT
+#  endif
+# endif
+#endif
+#ifndef QCOMMANDLINESERVER_EXPORT
+# define QCOMMANDLINESERVER_EXPORT
+#endif
+
+class QCommandLineServerPrivate;
+
+/**
+ * @brief Local socket control channel for a running program
+ *
+ * Listens on a QLocalServer and gives every request to
+ * QCommandLine::reparse(), so only the switches and options that
+ * changed are emitted again.
+ *
+ * A request is one argument per line, ended by an empty line; the
+ * program name is added in front of it. The reply is a single line,
+ * "ok" or "error: " followed by the parse error:
+ * @code
+ * printf -- '--verbose\n--level=3\n\n' | socat - UNIX-CONNECT:/tmp/mydaemon
+ * @endcode
+ */
+class QCOMMANDLINESERVER_EXPORT QCommandLineServer : public QObject
+{
+  Q_OBJECT
+public:
+    /**
+     * QCommandLineServer constructor
+     * @param cmdline The parser given the requests, must outlive the server
+     * @param parent The parent for this object
+     */
+    QCommandLineServer(QCommandLine * cmdline, QObject * parent = 0);
+
+    /**
+     * QCommandLineServer destructor
+     */
+   ~QCommandLineServer();
+
+    /**
+     * Start listening for requests.
+     *
+     * A socket left behind by an instance that exited is removed when
+     * it refuses connections; a socket another instance is listening
+     * on is kept, and listen() fails.
+     * @param name The socket name, see QLocalServer::listen()
+     * @returns true on success; otherwise returns false.
+     * @sa errorString
+     */
+    bool listen(const QString & name);
+
+    /**
+     * Stop listening and drop the connected clients
+     */
+    void close();
+
+    /**
+     * @returns true if the server is listening for requests
+     */
+    bool isListening() const;
+
+    /**
+     * @returns the full socket name, or an empty string when not listening
+     */
+    QString serverName() const;
+
+    /**
+     * @returns the reason listen() failed
+     */
+    QString errorString() const;
+
+private slots:
+    void newConnection();
+    void readRequest();
+    void dropClient();
+
+private:
+    QCommandLineServerPrivate *d;
+};
+
+#endif
@@ -0,0 +1,236 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "qcommandlinesession.h"
+#include "qcommandlinecore_p.h"
+#include "qcommandlineglob_p.h"
+#include "qcommandlinevalidator_p.h"
+
+/* Parser state before an argument */
+struct QCommandLineSessionState {
+    int nextParam; /* current Param */
+    bool allparam; /* a '+' was found */
+    int option; /* slot of the option waiting for its value, or -1 */
+};
+
+class QCommandLineSessionPrivate {
+public:
+    QCommandLineSessionPrivate(QCommandLineCore & parser);
+
+    QCommandLineCore & parser;
+    int generation; /* of the spec the arguments were classified with */
+    QStringList args;
+    QVector< QCommandLineSession::Token > tokens;
+    /* State before each argument, and after the last one */
+    QVector< QCommandLineSessionState > states;
+};
+
+QCommandLineSessionPrivate::QCommandLineSessionPrivate(QCommandLineCore & parser)
+  : parser(parser), generation(-1)
+{
+}
+
+static QCommandLineSession::Token
+token(const QCommandLineSpec & spec, QCommandLineSession::Kind kind, int slot)
+{
+  QCommandLineSession::Token token;
+
+  token.kind = kind;
+  token.id = spec.nameIds.at(spec.names.at(slot));
+  return token;
+}
+
+static QCommandLineSession::Token
+error()
+{
+  QCommandLineSession::Token token;
+
+  token.kind = QCommandLineSession::Error;
+  token.id = QCommandLineCore::InvalidId;
+  return token;
+}
+
+static QCommandLineSession::Token
+param(const QCommandLineSpec & spec, const QString & arg, QCommandLineSessionState & state)
+{
+  if (state.nextParam == spec.params.size())
+    return error();
+
+  int slot = spec.params.at(state.nextParam);
+  const QCommandLineConfigEntry & entry = *spec.entries.at(slot);
+
+  if (!(entry.flags & QCommandLineCore::Multiple))
+    state.nextParam++;
+
+  /* Patterns are only checked once expanded, by parse() */
+  if ((entry.flags & QCommandLineCore::Glob) && (entry.flags & QCommandLineCore::Multiple) &&
+      QCommandLineGlob::hasWildcards(arg))
+    return token(spec, QCommandLineSession::Param, slot);
+  if (!QCommandLineChecker::isValid(spec, slot, arg))
+    return error();
+  return token(spec, QCommandLineSession::Param, slot);
+}
+
+/* Classify arg like the parse loop does, and update state for the next one */
+static QCommandLineSession::Token
+classify(const QCommandLineSpec & spec, const QString & arg, QCommandLineSessionState & state)
+{
+  QHash < QString, QCommandLineKey >::const_iterator it;
+
+  if (state.option != -1) {
+    int slot = state.option;
+
+    state.option = -1;
+    if (arg.startsWith(QLatin1Char('-')) || !QCommandLineChecker::isValid(spec, slot, arg))
+      return error();
+    return token(spec, QCommandLineSession::Value, slot);
+  }
+
+  if (!state.allparam && arg == QLatin1String("-") && state.nextParam < spec.params.size()) {
+    int slot = spec.params.at(state.nextParam);
+    const QCommandLineConfigEntry & entry = *spec.entries.at(slot);
+
+    if ((entry.flags & QCommandLineCore::Stream) && (entry.flags & QCommandLineCore::Multiple))
+      return token(spec, QCommandLineSession::Param, slot);
+  }
+
+  if (state.allparam ||
+      (!arg.startsWith(QLatin1Char('-')) && !arg.startsWith(QLatin1Char('+'))))
+    return param(spec, arg, state);
+
+  if (arg.startsWith(QLatin1String("--"))) {
+    int idx = arg.indexOf(QLatin1Char('='));
+
+    it = spec.longKeys.constFind(idx == -1 ? arg.mid(2) : arg.mid(2, idx - 2));
+    if (it == spec.longKeys.constEnd())
+      return error();
+
+    int slot = it.value().slot;
+
+    if (spec.entries.at(slot)->type == QCommandLineCore::Switch)
+      return token(spec, QCommandLineSession::Switch, slot);
+    if (idx == -1)
+      state.option = slot;
+    else if (!QCommandLineChecker::isValid(spec, slot, arg.mid(idx + 1)))
+      return error();
+    return token(spec, QCommandLineSession::Option, slot);
+  }
+
+  /* Stacked args like `tar -xzf`, an option can only be the last one */
+  if (arg.startsWith(QLatin1Char('+'))) {
+    state.allparam = true;
+
+    it = spec.shortKeys.constFind(arg.mid(1, 1));
+    if (it == spec.shortKeys.constEnd())
+      return error();
+
+    int slot = it.value().slot;
+    /* The rest is parsed once '+' made everything a param */
+    QString rest = arg.size() > 2 ? arg.mid(0, 1) + arg.mid(2) : QString();
+
+    if (spec.entries.at(slot)->type == QCommandLineCore::Switch) {
+      if (!rest.isEmpty() && param(spec, rest, state).kind == QCommandLineSession::Error)
+	return error();
+      return token(spec, QCommandLineSession::Switch, slot);
+    }
+    if (rest.isEmpty())
+      state.option = slot;
+    else if (!QCommandLineChecker::isValid(spec, slot, rest))
+      return error();
+    return token(spec, QCommandLineSession::Option, slot);
+  }
+
+  QCommandLineSession::Token last = error();
+
+  for (int i = 1; i < qMax(arg.size(), 2); ++i) {
+    it = spec.shortKeys.constFind(arg.mid(i, 1));
+    if (it == spec.shortKeys.constEnd())
+      return error();
+
+    int slot = it.value().slot;
+
+    if (spec.entries.at(slot)->type == QCommandLineCore::Switch) {
+      last = token(spec, QCommandLineSession::Switch, slot);
+      continue;
+    }
+    /* Its value would be the rest, starting with '-' */
+    if (i + 1 < arg.size())
+      return error();
+    state.option = slot;
+    last = token(spec, QCommandLineSession::Option, slot);
+  }
+  return last;
+}
+
+QCommandLineSession::QCommandLineSession(QCommandLineCore & parser)
+  : d(new QCommandLineSessionPrivate(parser))
+{
+  reset();
+}
+
+QCommandLineSession::~QCommandLineSession()
+{
+  delete d;
+}
+
+const QVector< QCommandLineSession::Token > &
+QCommandLineSession::update(const QStringList & args)
+{
+  const QCommandLineSpec & spec = *d->parser.d->acquire();
+  int same = 0;
+
+  if (d->generation != spec.generation) {
+    reset();
+    d->generation = spec.generation;
+  }
+
+  while (same < args.size() && same < d->args.size() && args.at(same) == d->args.at(same))
+    same++;
+
+  d->tokens.resize(same);
+  d->states.resize(same + 1);
+
+  QCommandLineSessionState state = d->states.at(same);
+
+  for (int i = same; i < args.size(); ++i) {
+    d->tokens << classify(spec, args.at(i), state);
+    d->states << state;
+  }
+  d->args = args;
+  d->parser.d->release(&spec);
+  return d->tokens;
+}
+
+const QVector< QCommandLineSession::Token > &
+QCommandLineSession::tokens() const
+{
+  return d->tokens;
+}
+
+void
+QCommandLineSession::reset()
+{
+  QCommandLineSessionState initial = { 0, false, -1 };
+
+  d->args.clear();
+  d->tokens.clear();
+  d->states.clear();
+  d->states << initial;
+}
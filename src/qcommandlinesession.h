@@ -0,0 +1,113 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef QCOMMAND_LINE_SESSION_H
+# define QCOMMAND_LINE_SESSION_H
+
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+#include "qcommandlinecore.h"
+
+class QCommandLineSessionPrivate;
+
+/**
+ * @brief Incremental classification of a command line being edited
+ *
+ * Meant for interactive shells that validate or highlight the line on
+ * every keystroke. The session remembers the parser state before each
+ * argument, so that update() only classifies the arguments from the
+ * first one that changed instead of the whole line.
+ *
+ * Arguments are classified one by one with the parser configuration and
+ * validators: unlike QCommandLineCore::parse(), classification goes on
+ * after an error, missing mandatory entries are not reported, Glob and
+ * Stream params are not expanded, and values are not checked on the
+ * filesystem (QCommandLineValidator::Exists and the like), so that a
+ * keystroke never waits for a slow disk or network mount.
+ *
+ * The state is kept until the parser configuration changes.
+ */
+class QCOMMANDLINECORE_EXPORT QCommandLineSession
+{
+public:
+    /**
+     * Classification of an argument
+     */
+    typedef enum {
+	Switch, /**< one or more switchs (eg: -l, --all, -la) */
+	Option, /**< an option, with its value if given as --name=value */
+	Value, /**< the value of the option before it */
+	Param, /**< a param */
+	Error /**< an argument parse() would fail on, or an invalid value */
+    } Kind;
+
+    /**
+     * Classification of a single argument
+     */
+    struct Token {
+	Kind kind;
+	/**
+	 * The id of the entry, the last one for stacked switchs,
+	 * QCommandLineCore::InvalidId for errors
+	 */
+	int id;
+    };
+
+    /**
+     * QCommandLineSession constructor
+     * @param parser The parser whose configuration is used, it must outlive the session
+     */
+    QCommandLineSession(QCommandLineCore & parser);
+
+    /**
+     * QCommandLineSession destructor
+     */
+    ~QCommandLineSession();
+
+    /**
+     * Classify the arguments of the edited line.
+     *
+     * Arguments up to the first one that differs from the previous call
+     * keep their classification, only the following ones are classified
+     * again. Everything is classified again after the parser
+     * configuration changed.
+     * @param args The arguments, without the program name
+     * @returns The classification of each argument
+     */
+    const QVector< Token > & update(const QStringList & args);
+
+    /**
+     * Get the classification of the last update().
+     * @returns The classification of each argument
+     */
+    const QVector< Token > & tokens() const;
+
+    /**
+     * Forget the previous arguments, the next update() classifies them all.
+     */
+    void reset();
+
+private:
+    Q_DISABLE_COPY(QCommandLineSession)
+    QCommandLineSessionPrivate *d;
+};
+
+#endif
@@ -0,0 +1,252 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <QtCore/QFileInfo>
+#ifndef QT_NO_CONCURRENT
+# include <QtCore/QtConcurrentMap>
+#endif
+
+#include "qcommandlinerange.h"
+#include "qcommandlinevalidator_p.h"
+
+/* Params queued before their batch is checked */
+static const int batchSize = 4096;
+
+static const int pathChecks = QCommandLineValidator::Exists | QCommandLineValidator::File |
+  QCommandLineValidator::Dir | QCommandLineValidator::Readable;
+
+/*
+ * Run from the thread pool, returns the first check failed by the value,
+ * or None. Messages are built by the caller, in the parser thread.
+ */
+static int
+failedPathCheck(const QCommandLineCheck & check)
+{
+  QFileInfo info(check.value);
+
+  if (!info.exists())
+    return QCommandLineValidator::Exists;
+  if ((check.checks & QCommandLineValidator::File) && !info.isFile())
+    return QCommandLineValidator::File;
+  if ((check.checks & QCommandLineValidator::Dir) && !info.isDir())
+    return QCommandLineValidator::Dir;
+  if ((check.checks & QCommandLineValidator::Readable) && !info.isReadable())
+    return QCommandLineValidator::Readable;
+  return QCommandLineValidator::None;
+}
+
+static const char *
+pathMessage(int check)
+{
+  switch (check) {
+  case QCommandLineValidator::File:
+    return QT_TRANSLATE_NOOP("QCommandLine", "Argument %1, %2: '%3' is not a file");
+  case QCommandLineValidator::Dir:
+    return QT_TRANSLATE_NOOP("QCommandLine", "Argument %1, %2: '%3' is not a directory");
+  case QCommandLineValidator::Readable:
+    return QT_TRANSLATE_NOOP("QCommandLine", "Argument %1, %2: '%3' is not readable");
+  default:
+    return QT_TRANSLATE_NOOP("QCommandLine", "Argument %1, %2: '%3' does not exist");
+  }
+}
+
+static bool
+isNumberInRange(const QCommandLineValidator & validator, const QString & value)
+{
+  bool ok;
+  double number = value.toDouble(&ok);
+
+  return ok && number >= validator.min && number <= validator.max;
+}
+
+/*
+ * QRegExp keeps the state of the last match, the pattern compiled when
+ * the spec was built is shared with a copy used by this thread only.
+ */
+static bool
+matches(const QCommandLineSpec & spec, int slot, const QString & value)
+{
+  QRegExp rx = spec.patterns.at(slot);
+
+  return rx.exactMatch(value);
+}
+
+QCommandLineChecker::QCommandLineChecker(const QCommandLineSpec & spec,
+					 QCommandLineHandler & handler)
+  : slot(0), argument(0), failed(false), bytes(0), paramPaths(true), spec(spec), handler(handler)
+{
+}
+
+void
+QCommandLineChecker::fail(int argument, int slot, const QString & value, const char *message,
+			  const QStringList & args)
+{
+  failed = true;
+  handler.errorFound(QCommandLineError(message, QStringList() << QString::number(argument) <<
+				       spec.entries.at(slot)->longName << value << args));
+}
+
+/* Checks that don't need the filesystem */
+bool
+QCommandLineChecker::check(int slot, const QString & value)
+{
+  const QCommandLineValidator & validator = spec.validators.at(slot);
+
+  if ((validator.checks & QCommandLineValidator::Pattern) && !matches(spec, slot, value)) {
+    /* Earlier values are reported first */
+    if (flush())
+      fail(argument, slot, value, QT_TRANSLATE_NOOP("QCommandLine", "Argument %1, %2: '%3' does not match %4"),
+	   QStringList() << validator.pattern);
+    return false;
+  }
+
+  if ((validator.checks & QCommandLineValidator::Number) && !isNumberInRange(validator, value)) {
+    if (flush())
+      fail(argument, slot, value, QT_TRANSLATE_NOOP("QCommandLine", "Argument %1, %2: '%3' is not a number between %4 and %5"),
+	   QStringList() << QString::number(validator.min) << QString::number(validator.max));
+    return false;
+  }
+  return true;
+}
+
+bool
+QCommandLineChecker::isValid(const QCommandLineSpec & spec, int slot, const QString & value)
+{
+  const QCommandLineValidator & validator = spec.validators.at(slot);
+
+  if (spec.entries.at(slot)->type == QCommandLineCore::Range) {
+    bool ok;
+
+    QCommandLineRange::fromString(value, &ok);
+    return ok;
+  }
+  if ((validator.checks & QCommandLineValidator::Pattern) && !matches(spec, slot, value))
+    return false;
+  return !(validator.checks & QCommandLineValidator::Number) || isNumberInRange(validator, value);
+}
+
+void
+QCommandLineChecker::queue(QList< QCommandLineCheck > & checks, int slot, const QString & value)
+{
+  QCommandLineCheck check;
+
+  check.argument = argument;
+  check.slot = slot;
+  check.checks = spec.validators.at(slot).checks & pathChecks;
+  check.id = spec.nameIds.at(spec.names.at(slot));
+  check.name = spec.nameStrings.at(spec.names.at(slot));
+  check.value = value;
+  checks << check;
+}
+
+void
+QCommandLineChecker::paramFound(int id, const QString & name, const QString & value)
+{
+  const QCommandLineConfigEntry & entry = *spec.entries.at(slot);
+
+  if (failed)
+    return ;
+
+  if ((entry.flags & QCommandLineCore::Unique) && (entry.flags & QCommandLineCore::Multiple)) {
+    QSet< QString > & values = seen[slot];
+
+    if (values.contains(value))
+      return ;
+    values.insert(value);
+    /* The node and its bucket, the string itself is shared */
+    bytes += 2 * sizeof(void *) + sizeof(uint) + sizeof(QString);
+  }
+
+  if (!check(slot, value))
+    return ;
+
+  if (params.isEmpty() && (!paramPaths || !(spec.validators.at(slot).checks & pathChecks))) {
+    handler.paramFound(id, name, value);
+    return ;
+  }
+
+  queue(params, slot, value);
+  if (params.size() >= batchSize)
+    flush();
+}
+
+void
+QCommandLineChecker::errorFound(const QCommandLineError & error)
+{
+  if (failed || !flush())
+    return ;
+  failed = true;
+  handler.errorFound(error);
+}
+
+bool
+QCommandLineChecker::checkOption(int slot, const QString & value)
+{
+  if (failed || !check(slot, value))
+    return false;
+  if (spec.validators.at(slot).checks & pathChecks)
+    queue(options, slot, value);
+  return true;
+}
+
+bool
+QCommandLineChecker::checkPaths(QList< QCommandLineCheck > & checks, bool deliver)
+{
+  if (failed)
+    return false;
+  if (checks.isEmpty())
+    return true;
+
+#ifndef QT_NO_CONCURRENT
+  QList< int > results = QtConcurrent::blockingMapped< QList< int > >(checks, failedPathCheck);
+#else
+  QList< int > results;
+
+  foreach (const QCommandLineCheck & check, checks)
+    results << failedPathCheck(check);
+#endif
+
+  for (int i = 0; i < checks.size(); ++i) {
+    const QCommandLineCheck & check = checks.at(i);
+
+    if (results.at(i) != QCommandLineValidator::None) {
+      fail(check.argument, check.slot, check.value, pathMessage(results.at(i)));
+      break;
+    }
+    if (deliver)
+      handler.paramFound(check.id, check.name, check.value);
+  }
+  checks.clear();
+  return !failed;
+}
+
+/* Check and report the queued params */
+bool
+QCommandLineChecker::flush()
+{
+  return checkPaths(params, true);
+}
+
+/* Check the queued option values, after the params */
+bool
+QCommandLineChecker::flushOptions()
+{
+  return flush() && checkPaths(options, false);
+}
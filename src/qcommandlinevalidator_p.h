@@ -0,0 +1,86 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef QCOMMAND_LINE_VALIDATOR_P_H
+# define QCOMMAND_LINE_VALIDATOR_P_H
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QSet>
+
+#include "qcommandlinecore_p.h"
+
+/* A value waiting for its filesystem checks */
+struct QCommandLineCheck {
+    int argument;
+    int slot;
+    int checks;
+    int id;
+    QString name;
+    QString value;
+};
+
+/*
+ * Applies the validators of the spec to the values found by the parser.
+ *
+ * Params and parse errors are given to it instead of the handler. Values
+ * without filesystem checks are passed through right away, unless
+ * params are already waiting before them. The others are queued and
+ * checked by batches on QtConcurrent's thread pool, then given to the
+ * handler in order. Option values are only checked, the parser reports
+ * them itself once flushOptions() succeeded. After the first invalid
+ * value, failed is set and nothing else is given to the handler.
+ * Duplicate values of Unique params are dropped before being checked.
+ */
+class QCommandLineChecker : public QCommandLineHandler {
+public:
+    QCommandLineChecker(const QCommandLineSpec & spec, QCommandLineHandler & handler);
+
+    int slot; /* slot of the param being parsed */
+    int argument; /* index of the argument being parsed */
+    bool failed;
+    qint64 bytes; /* rough memory used by the values kept */
+    bool paramPaths; /* false: params skip the filesystem checks */
+
+    virtual void paramFound(int id, const QString & name, const QString & value);
+    virtual void errorFound(const QCommandLineError & error);
+
+    bool checkOption(int slot, const QString & value);
+    bool flush();
+    bool flushOptions();
+
+    /* The checks not touching the filesystem, in this thread */
+    static bool isValid(const QCommandLineSpec & spec, int slot, const QString & value);
+
+private:
+    bool check(int slot, const QString & value);
+    bool checkPaths(QList< QCommandLineCheck > & checks, bool deliver);
+    void queue(QList< QCommandLineCheck > & checks, int slot, const QString & value);
+    void fail(int argument, int slot, const QString & value, const char *message,
+	      const QStringList & args = QStringList());
+
+    const QCommandLineSpec & spec;
+    QCommandLineHandler & handler;
+    QList< QCommandLineCheck > params;
+    QList< QCommandLineCheck > options;
+    QHash< int, QSet< QString > > seen; /* values of Unique params, by slot */
+};
+
+#endif
@@ -0,0 +1,62 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef QCOMMAND_LINE_TESTUTILS_H
+# define QCOMMAND_LINE_TESTUTILS_H
+
+#include <QtCore/QStringList>
+
+#include "qcommandlinecore.h"
+
+/* Arguments written as a line split on spaces, without the program name */
+static inline QStringList
+words(const QString & line)
+{
+  return line.split(QLatin1Char(' '), QString::SkipEmptyParts);
+}
+
+/* Arguments written as a line, after the program name */
+static inline QStringList
+arguments(const QString & line)
+{
+  return QStringList() << QLatin1String("test") << words(line);
+}
+
+/* An event as "P name value": kind initial, name and value */
+static inline QString
+eventLine(QCommandLineEvent::Kind kind, const QString & name, const QString & value)
+{
+  static const char kinds[] = "SOPE";
+
+  return QString(QLatin1Char(kinds[kind])) + QLatin1Char(' ') + name + QLatin1Char(' ') + value;
+}
+
+/* All the events of a result, as eventLine() */
+static inline QStringList
+eventLines(const QCommandLineResult & result)
+{
+  QStringList lines;
+
+  foreach (const QCommandLineEvent & event, result.events)
+    lines << eventLine(event.kind, event.name, event.value);
+  return lines;
+}
+
+#endif
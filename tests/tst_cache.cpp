@@ -0,0 +1,285 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Result cache: a hit replays the stored results, a change of the
+ * arguments, of the configuration or of a checked file is a miss, and
+ * old files are dropped.
+ */
+
+#include <QtTest/QtTest>
+
+#ifdef Q_OS_UNIX
+# include <sys/stat.h>
+# include <sys/types.h>
+# include <utime.h>
+#endif
+
+#include "qcommandlinecore.h"
+#include "testutils.h"
+
+/* Files kept in the cache directory */
+static const int maxFiles = 256;
+
+/* Results, with ranges told apart from options */
+class RangeResult : public QCommandLineResult
+{
+public:
+  void rangeFound(int id, const QString & name, const QCommandLineRange & range)
+  {
+    ranges << name + QLatin1Char(' ') + range.toString();
+    QCommandLineResult::rangeFound(id, name, range);
+  }
+
+  QStringList ranges;
+};
+
+class TestCache : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void initTestCase();
+  void cleanupTestCase();
+  void init();
+  void cleanup();
+  void hit();
+  void argv();
+  void config();
+  void files();
+  void eviction();
+
+private:
+  bool parse(const QString & line, RangeResult & result);
+  QStringList cacheFiles() const;
+  qint64 inode(const QString & path) const;
+  bool touch(const QString & path, int age) const;
+
+  QString dir;
+  QString input;
+  QCommandLineCore *cmdline;
+};
+
+void
+TestCache::initTestCase()
+{
+#ifndef Q_OS_UNIX
+  QSKIP("cache files are told apart by inode", SkipAll);
+#endif
+  QString base = QDir::temp().absoluteFilePath(QString::fromLatin1("tst_cache.%1")
+					       .arg(QCoreApplication::applicationPid()));
+
+  dir = base + QLatin1String(".d");
+  input = base + QLatin1String(".input");
+}
+
+void
+TestCache::cleanupTestCase()
+{
+  QFile::remove(input);
+}
+
+void
+TestCache::init()
+{
+  QCommandLineConfigEntry verbose = { QCommandLineCore::Switch, QLatin1Char('v'), QLatin1String("verbose"),
+				      QString(), QCommandLineCore::Optional };
+  QCommandLineConfigEntry level = { QCommandLineCore::Option, QLatin1Char('l'), QLatin1String("level"),
+				    QString(), QCommandLineCore::Optional };
+  QCommandLineConfigEntry shard = { QCommandLineCore::Range, QLatin1Char('s'), QLatin1String("shard"),
+				    QString(), QCommandLineCore::OptionalMultiple };
+  QCommandLineConfigEntry file = { QCommandLineCore::Param, QChar(), QLatin1String("input"),
+				   QString(), QCommandLineCore::Optional };
+  QFile data(input);
+
+  QVERIFY(data.open(QIODevice::WriteOnly | QIODevice::Truncate));
+  data.write("1\n");
+  data.close();
+
+  cmdline = new QCommandLineCore(QStringList(), QCommandLineConfig() << verbose << level << shard << file);
+  cmdline->setValidator(QLatin1String("input"), QCommandLineValidator(QCommandLineValidator::File));
+  cmdline->setCacheDir(dir);
+}
+
+void
+TestCache::cleanup()
+{
+  delete cmdline;
+  foreach (const QString & name, QDir(dir).entryList(QDir::Files | QDir::Hidden))
+    QFile::remove(QDir(dir).filePath(name));
+  QDir().rmdir(dir);
+}
+
+/* Parse line, where "@" stands for the input file */
+bool
+TestCache::parse(const QString & line, RangeResult & result)
+{
+  return cmdline->parse(arguments(QString(line).replace(QLatin1Char('@'), input)), result);
+}
+
+QStringList
+TestCache::cacheFiles() const
+{
+  return QDir(dir).entryList(QStringList() << QLatin1String("*.qclc"), QDir::Files, QDir::Name);
+}
+
+/* A file rewritten by the cache gets a new inode */
+qint64
+TestCache::inode(const QString & path) const
+{
+#ifdef Q_OS_UNIX
+  struct stat st;
+
+  if (stat(QFile::encodeName(QDir(dir).filePath(path)).constData(), &st) == 0)
+    return st.st_ino;
+#else
+  Q_UNUSED(path);
+#endif
+  return -1;
+}
+
+/* Set the modification time of path to age seconds ago */
+bool
+TestCache::touch(const QString & path, int age) const
+{
+#ifdef Q_OS_UNIX
+  struct utimbuf times;
+
+  times.actime = times.modtime = QDateTime::currentDateTime().toTime_t() - age;
+  return utime(QFile::encodeName(path).constData(), &times) == 0;
+#else
+  Q_UNUSED(path);
+  Q_UNUSED(age);
+  return false;
+#endif
+}
+
+void
+TestCache::hit()
+{
+  RangeResult first, second;
+  QString line = QLatin1String("-v --level=3 -s 1-3 -s 7 @");
+
+  QVERIFY(parse(line, first));
+  QCOMPARE(cacheFiles().size(), 1);
+  qint64 stored = inode(cacheFiles().first());
+
+  /* Replayed: the same results, ranges included, and the file is kept */
+  QVERIFY(parse(line, second));
+  QCOMPARE(eventLines(second), eventLines(first));
+  QCOMPARE(second.ranges, QStringList() << QLatin1String("shard 1-3,7"));
+  QCOMPARE(cacheFiles().size(), 1);
+  QCOMPARE(inode(cacheFiles().first()), stored);
+
+  /* Failed parses are not stored */
+  RangeResult failed;
+
+  QVERIFY(!parse(QLatin1String("--bogus"), failed));
+  QCOMPARE(cacheFiles().size(), 1);
+}
+
+void
+TestCache::argv()
+{
+  RangeResult a, b, c;
+
+  QVERIFY(parse(QLatin1String("-v"), a));
+  QVERIFY(parse(QLatin1String("-l 2"), b));
+  QCOMPARE(cacheFiles().size(), 2);
+  QVERIFY(parse(QLatin1String("-v"), c));
+  QCOMPARE(eventLines(c), eventLines(a));
+  QCOMPARE(cacheFiles().size(), 2);
+}
+
+void
+TestCache::config()
+{
+  RangeResult before, after, validated;
+
+  QVERIFY(parse(QLatin1String("-v"), before));
+  cmdline->addSwitch(QLatin1Char('q'), QLatin1String("quiet"));
+  QVERIFY(parse(QLatin1String("-v"), after));
+  QCOMPARE(cacheFiles().size(), 2);
+
+  /* Validators are part of the configuration */
+  cmdline->setValidator(QLatin1String("level"),
+			QCommandLineValidator(QCommandLineValidator::Number, QString(), 1, 5));
+  QVERIFY(parse(QLatin1String("-v"), validated));
+  QCOMPARE(cacheFiles().size(), 3);
+}
+
+void
+TestCache::files()
+{
+  RangeResult first, hit, resized, again, touched;
+  QString line = QLatin1String("@");
+
+  QVERIFY(parse(line, first));
+  qint64 stored = inode(cacheFiles().first());
+
+  QVERIFY(parse(line, hit));
+  QCOMPARE(inode(cacheFiles().first()), stored);
+
+  /* The size of a checked file changed: parsed and stored again */
+  QFile data(input);
+
+  QVERIFY(data.open(QIODevice::Append));
+  data.write("2\n");
+  data.close();
+  QVERIFY(parse(line, resized));
+  QCOMPARE(cacheFiles().size(), 1);
+  QVERIFY(inode(cacheFiles().first()) != stored);
+  stored = inode(cacheFiles().first());
+
+  QVERIFY(parse(line, again));
+  QCOMPARE(inode(cacheFiles().first()), stored);
+
+  /* Only its modification time */
+  QVERIFY(touch(input, 60));
+  QVERIFY(parse(line, touched));
+  QVERIFY(inode(cacheFiles().first()) != stored);
+  QCOMPARE(eventLines(touched), eventLines(first));
+}
+
+void
+TestCache::eviction()
+{
+  RangeResult old;
+
+  QVERIFY(parse(QLatin1String("-l old"), old));
+  QString oldest = cacheFiles().first();
+
+  /* Older than a month: dropped by the next write */
+  QVERIFY(touch(QDir(dir).filePath(oldest), 40 * 24 * 60 * 60));
+  QVERIFY(parse(QLatin1String("-l new"), old));
+  QVERIFY(!cacheFiles().contains(oldest));
+  QCOMPARE(cacheFiles().size(), 1);
+
+  /* No more than maxFiles */
+  for (int i = 0; i < maxFiles + 10; ++i) {
+    RangeResult result;
+
+    QVERIFY(parse(QString::fromLatin1("-l %1").arg(i), result));
+  }
+  QCOMPARE(cacheFiles().size(), maxFiles);
+}
+
+QTEST_MAIN(TestCache)
+#include "tst_cache.moc"
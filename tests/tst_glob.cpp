@@ -0,0 +1,190 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Glob params: matches come in a stable order whatever the number of
+ * threads and however the walk is split, and are not reported twice.
+ */
+
+#include <QtTest/QtTest>
+
+#include "qcommandlinecore.h"
+#include "testutils.h"
+
+/* Directories below a/, more than a task walks in one go */
+static const int dirs = 200;
+/* Files in each of them, more than a task queues before it waits */
+static const int files = 20;
+
+class TestGlob : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void initTestCase();
+  void cleanupTestCase();
+  void init();
+  void cleanup();
+  void order_data();
+  void order();
+  void dedup();
+
+private:
+  QStringList expand(const QString & line, int flags = 0);
+  QString path(const QString & name) const;
+
+  QString root;
+  int threads;
+};
+
+static bool
+removeTree(const QString & path)
+{
+  QDir dir(path);
+
+  foreach (const QFileInfo & info, dir.entryInfoList(QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden)) {
+    if (info.isDir() && !info.isSymLink()) {
+      if (!removeTree(info.filePath()))
+	return false;
+    } else if (!dir.remove(info.fileName())) {
+      return false;
+    }
+  }
+  return dir.rmdir(path);
+}
+
+/* root/a/dNNN/fNN.gz, root/b/x.gz and root/b/y.txt */
+void
+TestGlob::initTestCase()
+{
+  root = QDir::temp().absoluteFilePath(QString::fromLatin1("tst_glob.%1")
+				       .arg(QCoreApplication::applicationPid()));
+  QVERIFY(!QFile::exists(root));
+
+  for (int d = 0; d < dirs; ++d) {
+    QString dir = path(QString::fromLatin1("a/d%1").arg(d, 3, 10, QLatin1Char('0')));
+
+    QVERIFY(QDir().mkpath(dir));
+    for (int f = 0; f < files; ++f) {
+      QFile file(dir + QString::fromLatin1("/f%1.gz").arg(f, 2, 10, QLatin1Char('0')));
+
+      QVERIFY(file.open(QIODevice::WriteOnly));
+    }
+  }
+
+  QVERIFY(QDir().mkpath(path(QLatin1String("b"))));
+  foreach (const QString & name, QStringList() << QLatin1String("b/x.gz") << QLatin1String("b/y.txt")) {
+    QFile file(path(name));
+
+    QVERIFY(file.open(QIODevice::WriteOnly));
+  }
+}
+
+void
+TestGlob::cleanupTestCase()
+{
+  QVERIFY(removeTree(root));
+}
+
+void
+TestGlob::init()
+{
+  threads = QThreadPool::globalInstance()->maxThreadCount();
+}
+
+void
+TestGlob::cleanup()
+{
+  QThreadPool::globalInstance()->setMaxThreadCount(threads);
+}
+
+QString
+TestGlob::path(const QString & name) const
+{
+  return root + QLatin1Char('/') + name;
+}
+
+/* Params reported for line, where "@" stands for the root directory */
+QStringList
+TestGlob::expand(const QString & line, int flags)
+{
+  QCommandLineCore cmdline;
+  QCommandLineResult result;
+
+  cmdline.addParam(QLatin1String("files"), QString(),
+		   QCommandLineCore::Flags(QCommandLineCore::Multiple | QCommandLineCore::Glob | flags));
+  if (!cmdline.parse(arguments(QString(line).replace(QLatin1Char('@'), root)), result))
+    return QStringList() << result.errorString();
+  return result.values(QLatin1String("files"));
+}
+
+void
+TestGlob::order_data()
+{
+  QTest::addColumn< int >("threads");
+
+  QTest::newRow("one thread") << 1;
+  QTest::newRow("every core") << qMax(2, QThread::idealThreadCount());
+}
+
+void
+TestGlob::order()
+{
+  QFETCH(int, threads);
+  QStringList expected;
+
+  QThreadPool::globalInstance()->setMaxThreadCount(threads);
+
+  /* Sorted by directory, then by name */
+  for (int d = 0; d < dirs; ++d)
+    for (int f = 0; f < files; ++f)
+      expected << path(QString::fromLatin1("a/d%1/f%2.gz")
+		       .arg(d, 3, 10, QLatin1Char('0')).arg(f, 2, 10, QLatin1Char('0')));
+
+  QCOMPARE(expand(QLatin1String("@/*/*/*.gz")), expected);
+  QCOMPARE(expand(QLatin1String("@/a/*/f1?.gz")).size(), dirs * 10);
+
+  /* '**' matches in the directory itself first, then below */
+  expected << path(QLatin1String("b/x.gz"));
+  QCOMPARE(expand(QLatin1String("@/**/*.gz")), expected);
+}
+
+void
+TestGlob::dedup()
+{
+  QStringList expected;
+
+  QCOMPARE(expand(QLatin1String("@/**/**/*.gz")), expand(QLatin1String("@/**/*.gz")));
+
+  /* Unique: a match is reported where it first appeared */
+  for (int f = 0; f < files; ++f)
+    expected << path(QString::fromLatin1("a/d000/f%1.gz").arg(f, 2, 10, QLatin1Char('0')));
+  expected << path(QLatin1String("b/x.gz"));
+
+  QCOMPARE(expand(QLatin1String("@/a/d000/f0*.gz @/a/d000/*.gz @/b/x.gz @/*/x.gz"),
+		  QCommandLineCore::Unique), expected);
+
+  /* Without it, every match of every pattern */
+  QCOMPARE(expand(QLatin1String("@/b/x.gz @/*/x.gz")),
+	   QStringList() << path(QLatin1String("b/x.gz")) << path(QLatin1String("b/x.gz")));
+}
+
+QTEST_MAIN(TestGlob)
+#include "tst_glob.moc"
@@ -0,0 +1,181 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Help message layout: description wrapping, terminal width, sections,
+ * the optional version line and translated descriptions.
+ */
+
+#include <QtTest/QtTest>
+#include <stdio.h>
+#ifdef Q_OS_UNIX
+# include <unistd.h>
+#endif
+
+#include "qcommandlinecore.h"
+
+/* Translates a few strings of the QCommandLine context */
+class Translator : public QTranslator
+{
+public:
+  QString translate(const char *context, const char *sourceText, const char *disambiguation = 0) const
+  {
+    Q_UNUSED(disambiguation);
+
+    if (qstrcmp(context, "QCommandLine"))
+      return QString();
+    if (!qstrcmp(sourceText, "Show more"))
+      return QString::fromLatin1("Plus de d\xe9tails");
+    if (!qstrcmp(sourceText, "Display this help and exit"))
+      return QString::fromLatin1("Afficher l'aide");
+    return QString();
+  }
+
+  bool isEmpty() const
+  {
+    return false;
+  }
+};
+
+class TestHelp : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void init();
+  void cleanup();
+  void layout();
+  void terminalWidth();
+  void logo();
+  void translated();
+
+private:
+  QCommandLineCore *cmdline;
+};
+
+void
+TestHelp::init()
+{
+  cmdline = new QCommandLineCore(QStringList() << QLatin1String("/usr/bin/prog"));
+  cmdline->addSwitch(QLatin1Char('v'), QLatin1String("verbose"), QLatin1String("Show more"));
+  cmdline->addSection(QLatin1String("Output"));
+  cmdline->addOption(QLatin1Char('o'), QLatin1String("output"),
+		     QLatin1String("Write the result to this file instead of the standard output"));
+  cmdline->addParam(QLatin1String("file"), QLatin1String("Input file"));
+}
+
+void
+TestHelp::cleanup()
+{
+  delete cmdline;
+}
+
+/* "-o,--output=<val>" is wider than half the screen: its description
+   starts on the next line, at the description column */
+static const char *help40 =
+  "Usage:\n"
+  "   prog [switchs] [options] [file]\n"
+  "\n"
+  "Options:\n"
+  "  -v,--verbose      Show more\n"
+  "\n"
+  "Output:\n"
+  "  -o,--output=<val>\n"
+  "                    Write the result to\n"
+  "                    this file instead of\n"
+  "                    the standard output\n"
+  "  file              Input file\n"
+  "\n"
+  "Mandatory arguments to long options are mandatory for short options too.\n";
+
+void
+TestHelp::layout()
+{
+  cmdline->setHelpWidth(40);
+  QCOMPARE(cmdline->helpWidth(), 40);
+  QCOMPARE(cmdline->help(), QString::fromLatin1(help40));
+
+  /* Wide enough for everything on one line */
+  cmdline->setHelpWidth(200);
+  QVERIFY(cmdline->help().contains(QLatin1String(
+    "  -o,--output=<val>  Write the result to this file instead of the standard output\n")));
+
+  /* The layout follows configuration changes */
+  cmdline->setHelpWidth(40);
+  cmdline->addSwitch(QLatin1Char('q'), QLatin1String("quiet"), QLatin1String("Show less"));
+  QVERIFY(cmdline->help().contains(QLatin1String("  -q,--quiet        Show less\n")));
+}
+
+void
+TestHelp::terminalWidth()
+{
+#ifdef Q_OS_UNIX
+  if (isatty(STDERR_FILENO))
+    QSKIP("the width of the terminal on stderr is used", SkipSingle);
+#endif
+  QByteArray columns = qgetenv("COLUMNS");
+
+  cmdline->setHelpWidth(0);
+  qputenv("COLUMNS", "40");
+  QCOMPARE(cmdline->help(), QString::fromLatin1(help40));
+
+  /* 80 columns when it can't be guessed */
+  qputenv("COLUMNS", "");
+  cmdline->setHelpWidth(80);
+  QString help80 = cmdline->help();
+  cmdline->setHelpWidth(0);
+  QCOMPARE(cmdline->help(), help80);
+
+  qputenv("COLUMNS", columns);
+}
+
+void
+TestHelp::logo()
+{
+  QString help = cmdline->help();
+
+  QVERIFY(help.startsWith(QLatin1String("Usage:\n")));
+  QCOMPARE(cmdline->help(true), cmdline->version() + QLatin1String("\n") + help);
+}
+
+void
+TestHelp::translated()
+{
+  Translator translator;
+  QString help;
+
+  cmdline->enableHelp(true);
+  cmdline->setHelpWidth(200);
+  QCoreApplication::installTranslator(&translator);
+  help = cmdline->help();
+  QCoreApplication::removeTranslator(&translator);
+
+  /* Application descriptions too, not only the built-in ones */
+  QVERIFY(help.contains(QString::fromLatin1("-v,--verbose       Plus de d\xe9tails\n")));
+  QVERIFY(help.contains(QLatin1String("-h,--help          Afficher l'aide\n")));
+  QVERIFY(help.contains(QLatin1String("Input file\n")));
+
+  help = cmdline->help();
+  QVERIFY(help.contains(QLatin1String("-v,--verbose       Show more\n")));
+  QVERIFY(help.contains(QLatin1String("-h,--help          Display this help and exit\n")));
+}
+
+QTEST_MAIN(TestHelp)
+#include "tst_help.moc"
@@ -0,0 +1,225 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Entry ids: given by setConfig() and add*(), kept when other entries
+ * are removed, shared by entries with the same longName, and emitted by
+ * QCommandLine with every switch, option and param.
+ */
+
+#include <QtTest/QtTest>
+
+#include "qcommandline.h"
+#include "testutils.h"
+
+/* Id signals emitted by a QCommandLine, as "kind id value" lines */
+class Recorder : public QObject
+{
+  Q_OBJECT
+
+public:
+  Recorder(QCommandLine *cmdline)
+  {
+    connect(cmdline, SIGNAL(switchFound(int)), this, SLOT(switchFound(int)));
+    connect(cmdline, SIGNAL(optionFound(int, const QVariant &)), this, SLOT(optionFound(int, const QVariant &)));
+    connect(cmdline, SIGNAL(paramFound(int, const QVariant &)), this, SLOT(paramFound(int, const QVariant &)));
+  }
+
+  QStringList emitted;
+
+public slots:
+  void switchFound(int id)
+  {
+    emitted << QString::fromLatin1("switch %1").arg(id);
+  }
+
+  void optionFound(int id, const QVariant & value)
+  {
+    emitted << QString::fromLatin1("option %1 %2").arg(id).arg(value.toString());
+  }
+
+  void paramFound(int id, const QVariant & value)
+  {
+    emitted << QString::fromLatin1("param %1 %2").arg(id).arg(value.toString());
+  }
+};
+
+class TestIds : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void config();
+  void builtin();
+  void shared();
+  void removeAdd();
+  void signalIds();
+};
+
+/* Events as "kind name id" */
+static QStringList
+idLines(const QCommandLineResult & result)
+{
+  QStringList lines;
+
+  foreach (const QCommandLineEvent & event, result.events)
+    lines << eventLine(event.kind, event.name, QString::number(event.id));
+  return lines;
+}
+
+void
+TestIds::config()
+{
+  QCommandLineConfigEntry list = { QCommandLineCore::Switch, QLatin1Char('l'), QLatin1String("list"),
+				   QString(), QCommandLineCore::Optional };
+  QCommandLineConfigEntry section = { QCommandLineCore::Section, QChar(), QLatin1String("Output"),
+				      QString(), QCommandLineCore::Default };
+  QCommandLineConfigEntry output = { QCommandLineCore::Option, QLatin1Char('o'), QLatin1String("output"),
+				     QString(), QCommandLineCore::Optional };
+  QCommandLineConfigEntry target = { QCommandLineCore::Param, QChar(), QLatin1String("target"),
+				     QString(), QCommandLineCore::Optional };
+  QCommandLineCore cmdline(QStringList(), QCommandLineConfig() << list << section << output << target);
+  QCommandLineResult result;
+
+  /* The index in the configuration, sections included */
+  QCOMPARE(cmdline.entryId(QLatin1String("list")), 0);
+  QCOMPARE(cmdline.entryId(QLatin1String("output")), 2);
+  QCOMPARE(cmdline.entryId(QLatin1String("target")), 3);
+  QCOMPARE(cmdline.entryId(QLatin1String("Output")), int(QCommandLineCore::InvalidId));
+  QCOMPARE(cmdline.entryId(QLatin1String("bogus")), int(QCommandLineCore::InvalidId));
+
+  QVERIFY(cmdline.parse(arguments(QLatin1String("-o out dst -l")), result));
+  QCOMPARE(idLines(result), QStringList()
+	   << QLatin1String("P target 3") << QLatin1String("S list 0") << QLatin1String("O output 2"));
+  QCOMPARE(result.switchCount(0), 1);
+  QCOMPARE(result.values(2), QStringList() << QLatin1String("out"));
+
+  /* A new configuration starts from 0 again */
+  cmdline.setConfig(QCommandLineConfig() << target);
+  QCOMPARE(cmdline.entryId(QLatin1String("target")), 0);
+  QCOMPARE(cmdline.entryId(QLatin1String("list")), int(QCommandLineCore::InvalidId));
+}
+
+void
+TestIds::builtin()
+{
+  QCommandLineCore cmdline;
+  QCommandLineResult result;
+
+  QCOMPARE(cmdline.entryId(QLatin1String("help")), int(QCommandLineCore::InvalidId));
+  cmdline.enableHelp(true);
+  cmdline.enableVersion(true);
+  QCOMPARE(cmdline.entryId(QLatin1String("help")), int(QCommandLineCore::HelpId));
+  QCOMPARE(cmdline.entryId(QLatin1String("version")), int(QCommandLineCore::VersionId));
+
+  /* QCommandLineCore reports them, QCommandLine shows them */
+  QVERIFY(cmdline.parse(arguments(QLatin1String("-h --version")), result));
+  QCOMPARE(idLines(result), QStringList()
+	   << QString::fromLatin1("S help %1").arg(QCommandLineCore::HelpId)
+	   << QString::fromLatin1("S version %1").arg(QCommandLineCore::VersionId));
+}
+
+void
+TestIds::shared()
+{
+  QCommandLineCore cmdline;
+  QCommandLineResult result;
+
+  int target = cmdline.addParam(QLatin1String("file"));
+  int sources = cmdline.addParam(QLatin1String("file"), QString(), QCommandLineCore::OptionalMultiple);
+  int verbose = cmdline.addSwitch(QLatin1Char('v'), QLatin1String("verbose"), QString(),
+				  QCommandLineCore::OptionalMultiple);
+  int loud = cmdline.addSwitch(QLatin1Char('w'), QLatin1String("verbose"), QString(),
+			       QCommandLineCore::OptionalMultiple);
+
+  QCOMPARE(target, 0);
+  QCOMPARE(sources, 1);
+  QCOMPARE(loud, 3);
+  QCOMPARE(cmdline.entryId(QLatin1String("file")), target);
+  QCOMPARE(cmdline.entryId(QLatin1String("verbose")), verbose);
+
+  /* Every entry sharing a longName is reported with the id of the first */
+  QVERIFY(cmdline.parse(arguments(QLatin1String("a b c -v -w")), result));
+  QCOMPARE(idLines(result), QStringList()
+	   << QLatin1String("P file 0") << QLatin1String("P file 0") << QLatin1String("P file 0")
+	   << QLatin1String("S verbose 2") << QLatin1String("S verbose 2"));
+  QCOMPARE(result.switchCount(verbose), 2);
+  QCOMPARE(result.switchCount(loud), 0);
+}
+
+void
+TestIds::removeAdd()
+{
+  QCommandLineCore cmdline;
+  QCommandLineResult result;
+
+  QCOMPARE(cmdline.addSwitch(QLatin1Char('a'), QLatin1String("all")), 0);
+  QCOMPARE(cmdline.addOption(QLatin1Char('b'), QLatin1String("block")), 1);
+  QCOMPARE(cmdline.addSwitch(QLatin1Char('c'), QLatin1String("color")), 2);
+
+  /* Ids are never reused, nor renumbered */
+  cmdline.removeOption(QLatin1String("block"));
+  QCOMPARE(cmdline.entryId(QLatin1String("block")), int(QCommandLineCore::InvalidId));
+  QCOMPARE(cmdline.entryId(QLatin1String("color")), 2);
+  QCOMPARE(cmdline.addOption(QLatin1Char('b'), QLatin1String("block")), 3);
+  QCOMPARE(cmdline.addSection(QLatin1String("More")), 4);
+  QCOMPARE(cmdline.addParam(QLatin1String("target")), 5);
+
+  QVERIFY(cmdline.parse(arguments(QLatin1String("-c -b 1 t -a")), result));
+  QCOMPARE(idLines(result), QStringList()
+	   << QLatin1String("P target 5") << QLatin1String("S color 2") << QLatin1String("S all 0")
+	   << QLatin1String("O block 3"));
+
+  cmdline.removeSwitch(QLatin1String("all"));
+  cmdline.removeParam(QLatin1String("target"));
+  QCOMPARE(cmdline.entryId(QLatin1String("color")), 2);
+  QCOMPARE(cmdline.entryId(QLatin1String("block")), 3);
+  QCOMPARE(cmdline.addParam(QLatin1String("target")), 6);
+}
+
+void
+TestIds::signalIds()
+{
+  QCommandLine cmdline(arguments(QLatin1String("-v -o out dst -w src")));
+  Recorder recorder(&cmdline);
+  int verbose = cmdline.addSwitch(QLatin1Char('v'), QLatin1String("verbose"), QString(),
+				  QCommandLineCore::OptionalMultiple);
+  int output = cmdline.addOption(QLatin1Char('o'), QLatin1String("output"));
+  int target = cmdline.addParam(QLatin1String("file"));
+  QSignalSpy named(&cmdline, SIGNAL(switchFound(const QString &)));
+
+  cmdline.addSwitch(QLatin1Char('w'), QLatin1String("verbose"), QString(), QCommandLineCore::OptionalMultiple);
+  cmdline.addParam(QLatin1String("file"), QString(), QCommandLineCore::OptionalMultiple);
+
+  QVERIFY(cmdline.parse());
+  QCOMPARE(recorder.emitted, QStringList()
+	   << QString::fromLatin1("param %1 dst").arg(target)
+	   << QString::fromLatin1("param %1 src").arg(target)
+	   << QString::fromLatin1("switch %1").arg(verbose)
+	   << QString::fromLatin1("switch %1").arg(verbose)
+	   << QString::fromLatin1("option %1 out").arg(output));
+
+  /* The name signals come along */
+  QCOMPARE(named.count(), 2);
+  QCOMPARE(named.at(0).at(0).toString(), QString::fromLatin1("verbose"));
+}
+
+QTEST_MAIN(TestIds)
+#include "tst_ids.moc"
@@ -0,0 +1,130 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Low memory mode: same results as the normal mode on a large argv,
+ * with a lower peakMemoryEstimate().
+ */
+
+#include <QtTest/QtTest>
+
+#include "qcommandlinecore.h"
+
+/* Arguments of the large command line */
+static const int count = 20000;
+
+class CountHandler : public QCommandLineHandler
+{
+public:
+  CountHandler()
+    : switches(0), params(0)
+  {
+  }
+
+  void switchFound(int, const QString &)
+  {
+    switches++;
+  }
+
+  void paramFound(int, const QString &, const QString & value)
+  {
+    params++;
+    last = value;
+  }
+
+  int switches;
+  int params;
+  QString last;
+};
+
+class TestMemory : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void initTestCase();
+  void modes();
+  void growth();
+
+private:
+  qint64 estimate(bool lowMemory, int argc, CountHandler & handler);
+
+  QList< QByteArray > storage;
+  QVector< char * > argv;
+};
+
+/* test -v file00000 file00001 ... */
+void
+TestMemory::initTestCase()
+{
+  storage << "test" << "-v";
+  for (int i = 0; i < count; ++i)
+    storage << QString::fromLatin1("file%1").arg(i, 5, 10, QLatin1Char('0')).toLatin1();
+  for (int i = 0; i < storage.size(); ++i)
+    argv << storage[i].data();
+  argv << 0;
+}
+
+/* Estimate for a parse of the first argc arguments */
+qint64
+TestMemory::estimate(bool lowMemory, int argc, CountHandler & handler)
+{
+  QCommandLineCore cmdline;
+
+  cmdline.enableLowMemory(lowMemory);
+  cmdline.setArguments(argc, argv.data());
+  cmdline.addSwitch(QLatin1Char('v'), QLatin1String("verbose"));
+  cmdline.addParam(QLatin1String("files"), QString(), QCommandLineCore::OptionalMultiple);
+
+  if (cmdline.peakMemoryEstimate() != 0 || !cmdline.parse(handler))
+    return -1;
+  return cmdline.peakMemoryEstimate();
+}
+
+void
+TestMemory::modes()
+{
+  CountHandler normal, low;
+  qint64 normalBytes = estimate(false, storage.size(), normal);
+  qint64 lowBytes = estimate(true, storage.size(), low);
+
+  QCOMPARE(low.switches, 1);
+  QCOMPARE(low.params, count);
+  QCOMPARE(low.last, normal.last);
+  QCOMPARE(low.params, normal.params);
+
+  QVERIFY(lowBytes > 0);
+  /* argv is used as is instead of a copy of every argument */
+  QVERIFY2(lowBytes + count * 9 * qint64(sizeof(QChar)) < normalBytes,
+	   qPrintable(QString::fromLatin1("low %1, normal %2").arg(lowBytes).arg(normalBytes)));
+}
+
+void
+TestMemory::growth()
+{
+  CountHandler small, large;
+
+  /* The arguments are counted in the normal mode only */
+  QVERIFY(estimate(false, 2 + count / 10, small) < estimate(false, storage.size(), large));
+  QVERIFY(estimate(true, 2 + count / 10, small) <= estimate(true, storage.size(), large));
+}
+
+QTEST_MAIN(TestMemory)
+#include "tst_memory.moc"
@@ -0,0 +1,188 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * QCommandLineRange: parsing, merging, membership and bounds, and Range
+ * options merged by the parser.
+ */
+
+#include <QtTest/QtTest>
+
+#include "qcommandlinecore.h"
+#include "qcommandlinerange.h"
+#include "testutils.h"
+
+class TestRange : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void parse_data();
+  void parse();
+  void invalid_data();
+  void invalid();
+  void contains();
+  void bounds();
+  void updates();
+  void option();
+};
+
+static QCommandLineRange
+range(const char *text)
+{
+  return QCommandLineRange::fromString(QLatin1String(text));
+}
+
+void
+TestRange::parse_data()
+{
+  QTest::addColumn< QString >("text");
+  QTest::addColumn< QString >("merged");
+
+  QTest::newRow("unsorted") << QString::fromLatin1("5-9,1,12") << QString::fromLatin1("1,5-9,12");
+  /* Overlapping, adjacent and repeated values are merged */
+  QTest::newRow("adjacent") << QString::fromLatin1("1-3,4-6") << QString::fromLatin1("1-6");
+  QTest::newRow("overlapping") << QString::fromLatin1("3-8,1-5") << QString::fromLatin1("1-8");
+  QTest::newRow("repeated") << QString::fromLatin1("2,2, 2") << QString::fromLatin1("2");
+  QTest::newRow("included") << QString::fromLatin1("0-3,2-3") << QString::fromLatin1("0-3");
+}
+
+void
+TestRange::parse()
+{
+  QFETCH(QString, text);
+  QFETCH(QString, merged);
+  bool ok;
+
+  QCOMPARE(QCommandLineRange::fromString(text, &ok).toString(), merged);
+  QVERIFY(ok);
+}
+
+void
+TestRange::invalid_data()
+{
+  QTest::addColumn< QString >("text");
+
+  QTest::newRow("empty") << QString();
+  QTest::newRow("letter") << QString::fromLatin1("a");
+  QTest::newRow("reversed") << QString::fromLatin1("5-1");
+  QTest::newRow("negative") << QString::fromLatin1("-3");
+  QTest::newRow("open") << QString::fromLatin1("1-");
+  QTest::newRow("empty item") << QString::fromLatin1("1,,2");
+  /* Large values could overflow when merging or counting */
+  QTest::newRow("too large") << QString::number(QCommandLineRange::MaxValue + 1);
+  QTest::newRow("int64 max") << QString::fromLatin1("0-9223372036854775807");
+}
+
+void
+TestRange::invalid()
+{
+  QFETCH(QString, text);
+  bool ok;
+  QCommandLineRange r = QCommandLineRange::fromString(text, &ok);
+
+  QVERIFY(!ok);
+  QVERIFY(r.isEmpty());
+}
+
+void
+TestRange::contains()
+{
+  QCommandLineRange r = range("5-9,1,12");
+
+  QCOMPARE(r.intervals().size(), 3);
+  QCOMPARE(r.count(), Q_INT64_C(7));
+  QVERIFY(r.contains(1) && !r.contains(2) && r.contains(5) && r.contains(9));
+  QVERIFY(!r.contains(10) && r.contains(12) && !r.contains(13) && !r.contains(0));
+  QVERIFY(range("0-3,2-3") == range("0-3"));
+}
+
+void
+TestRange::bounds()
+{
+  QString max = QString::number(QCommandLineRange::MaxValue);
+  bool ok;
+  QCommandLineRange all = QCommandLineRange::fromString(QLatin1String("0-") + max, &ok);
+
+  QVERIFY(ok);
+  QCOMPARE(all.count(), QCommandLineRange::MaxValue + 1);
+  QVERIFY(all.contains(QCommandLineRange::MaxValue) && all.contains(0));
+
+  /* Out of range intervals are ignored */
+  QCommandLineRange r;
+
+  r.add(5, 3);
+  r.add(-1, 2);
+  r.add(0, QCommandLineRange::MaxValue + 1);
+  QVERIFY(r.isEmpty());
+  r.add(QCommandLineRange::MaxValue - 1, QCommandLineRange::MaxValue);
+  r.add(QCommandLineRange::MaxValue, QCommandLineRange::MaxValue);
+  QCOMPARE(r.intervals().size(), 1);
+  QCOMPARE(r.count(), Q_INT64_C(2));
+}
+
+void
+TestRange::updates()
+{
+  QCommandLineRange r;
+
+  r.add(1, 2);
+  r.add(3, 4);
+  r.add(10, 10);
+  QCOMPARE(r.toString(), QString::fromLatin1("1-4,10"));
+  /* Out of order */
+  r.add(0, 0);
+  QCOMPARE(r.toString(), QString::fromLatin1("0-4,10"));
+
+  r.unite(range("5-9,20"));
+  QCOMPARE(r.toString(), QString::fromLatin1("0-10,20"));
+  r.unite(QCommandLineRange());
+  QCOMPARE(r.toString(), QString::fromLatin1("0-10,20"));
+
+  QCommandLineRange some = range("1-3,7");
+  QList< qint64 > values;
+
+  for (QCommandLineRange::const_iterator it = some.begin(); it != some.end(); ++it)
+    values << *it;
+  QCOMPARE(values, QList< qint64 >() << 1 << 2 << 3 << 7);
+  QVERIFY(QCommandLineRange().begin() == QCommandLineRange().end());
+}
+
+void
+TestRange::option()
+{
+  QCommandLineConfigEntry entry = { QCommandLineCore::Range, QLatin1Char('s'), QLatin1String("shard"),
+				    QString(), QCommandLineCore::OptionalMultiple };
+  QCommandLineCore cmdline(QStringList(), QCommandLineConfig() << entry);
+
+  /* Occurrences of a Multiple range are reported once, merged */
+  QCommandLineResult result;
+
+  QVERIFY(cmdline.parse(arguments(QLatin1String("--shard=1-3 -s 9,4")), result));
+  QCOMPARE(result.values(QLatin1String("shard")), QStringList() << QLatin1String("1-4,9"));
+
+  QCommandLineResult invalid;
+
+  QVERIFY(!cmdline.parse(arguments(QLatin1String("--shard=x")), invalid));
+  QVERIFY(invalid.errorString().endsWith(QLatin1String(": x")));
+}
+
+QTEST_MAIN(TestRange)
+#include "tst_range.moc"
@@ -0,0 +1,212 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * QCommandLine::reparse(): only the switches and options that changed
+ * are emitted, params are neither reported, required nor read.
+ */
+
+#include <QtTest/QtTest>
+#include <stdio.h>
+
+#include "qcommandline.h"
+#include "testutils.h"
+
+/* Signals emitted by a QCommandLine, as "kind name value" lines */
+class Recorder : public QObject
+{
+  Q_OBJECT
+
+public:
+  Recorder(QCommandLine *cmdline)
+  {
+    connect(cmdline, SIGNAL(switchFound(const QString &)), this, SLOT(switchFound(const QString &)));
+    connect(cmdline, SIGNAL(optionFound(const QString &, const QVariant &)),
+	    this, SLOT(optionFound(const QString &, const QVariant &)));
+    connect(cmdline, SIGNAL(paramFound(const QString &, const QVariant &)),
+	    this, SLOT(paramFound(const QString &, const QVariant &)));
+    connect(cmdline, SIGNAL(entryCleared(const QString &)), this, SLOT(entryCleared(const QString &)));
+    connect(cmdline, SIGNAL(parseError(const QString &)), this, SLOT(parseError(const QString &)));
+  }
+
+  /* What was emitted since the last call */
+  QStringList take()
+  {
+    QStringList taken = emitted;
+
+    emitted.clear();
+    return taken;
+  }
+
+public slots:
+  void switchFound(const QString & name)
+  {
+    emitted << QLatin1String("switch ") + name;
+  }
+
+  void optionFound(const QString & name, const QVariant & value)
+  {
+    emitted << QLatin1String("option ") + name + QLatin1Char(' ') + value.toString();
+  }
+
+  void paramFound(const QString & name, const QVariant & value)
+  {
+    emitted << QLatin1String("param ") + name + QLatin1Char(' ') + value.toString();
+  }
+
+  void entryCleared(const QString & name)
+  {
+    emitted << QLatin1String("cleared ") + name;
+  }
+
+  void parseError(const QString & error)
+  {
+    emitted << QLatin1String("error ") + error;
+  }
+
+private:
+  QStringList emitted;
+};
+
+class TestReparse : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void init();
+  void cleanup();
+  void changes();
+  void multiple();
+  void error();
+  void params();
+
+private:
+  QCommandLine *cmdline;
+  Recorder *recorder;
+};
+
+/* Like examples/test.cpp, with Mandatory params */
+void
+TestReparse::init()
+{
+  QCommandLineConfig config;
+  QCommandLineConfigEntry verbose = { QCommandLine::Switch, QLatin1Char('v'), QLatin1String("verbose"),
+				      QString(), QCommandLine::OptionalMultiple };
+  QCommandLineConfigEntry level = { QCommandLine::Option, QLatin1Char('l'), QLatin1String("level"),
+				    QString(), QCommandLine::Optional };
+  QCommandLineConfigEntry define = { QCommandLine::Option, QLatin1Char('D'), QLatin1String("define"),
+				     QString(), QCommandLine::OptionalMultiple };
+  QCommandLineConfigEntry target = { QCommandLine::Param, QChar(), QLatin1String("target"),
+				     QString(), QCommandLine::Mandatory };
+  QCommandLineConfigEntry source = { QCommandLine::Param, QChar(), QLatin1String("source"), QString(),
+				     QCommandLine::Flags(QCommandLine::MandatoryMultiple | QCommandLine::Stream) };
+
+  config << verbose << level << define << target << source;
+  cmdline = new QCommandLine(arguments(QLatin1String("-l 1 dst src")), config);
+  recorder = new Recorder(cmdline);
+
+  QVERIFY(cmdline->parse());
+  QCOMPARE(recorder->take(), QStringList()
+	   << QLatin1String("param target dst") << QLatin1String("param source src")
+	   << QLatin1String("option level 1"));
+}
+
+void
+TestReparse::cleanup()
+{
+  delete recorder;
+  delete cmdline;
+}
+
+void
+TestReparse::changes()
+{
+  /* The documented request: no param, so nothing Mandatory is missing */
+  QVERIFY(cmdline->reparse(arguments(QLatin1String("--verbose --level=3"))));
+  QCOMPARE(recorder->take(), QStringList()
+	   << QLatin1String("switch verbose")
+	   << QLatin1String("cleared level") << QLatin1String("option level 3"));
+  QCOMPARE(cmdline->arguments(), arguments(QLatin1String("--verbose --level=3")));
+
+  /* Nothing changed */
+  QVERIFY(cmdline->reparse(arguments(QLatin1String("--level=3 -v"))));
+  QCOMPARE(recorder->take(), QStringList());
+
+  /* Entries not given anymore are cleared first */
+  QVERIFY(cmdline->reparse(arguments(QLatin1String("-l 4"))));
+  QCOMPARE(recorder->take(), QStringList()
+	   << QLatin1String("cleared verbose")
+	   << QLatin1String("cleared level") << QLatin1String("option level 4"));
+
+  /* Help and version are never shown */
+  QVERIFY(cmdline->reparse(arguments(QLatin1String("-l 4 --help --version"))));
+  QCOMPARE(recorder->take(), QStringList());
+}
+
+void
+TestReparse::multiple()
+{
+  QVERIFY(cmdline->reparse(arguments(QLatin1String("-l 1 -D a -D b -v -v"))));
+  QCOMPARE(recorder->take(), QStringList()
+	   << QLatin1String("switch verbose") << QLatin1String("switch verbose")
+	   << QLatin1String("option define a") << QLatin1String("option define b"));
+
+  /* Every occurrence is given again, after a reset */
+  QVERIFY(cmdline->reparse(arguments(QLatin1String("-l 1 -D a -D c -v"))));
+  QCOMPARE(recorder->take(), QStringList()
+	   << QLatin1String("cleared verbose") << QLatin1String("switch verbose")
+	   << QLatin1String("cleared define")
+	   << QLatin1String("option define a") << QLatin1String("option define c"));
+}
+
+void
+TestReparse::error()
+{
+  QString error;
+
+  QVERIFY(!cmdline->reparse(arguments(QLatin1String("--bogus")), &error));
+  QCOMPARE(error, QString::fromLatin1("Unknown option: bogus"));
+  QCOMPARE(recorder->take(), QStringList() << QLatin1String("error Unknown option: bogus"));
+
+  /* Nothing changed */
+  QCOMPARE(cmdline->arguments(), arguments(QLatin1String("-l 1 dst src")));
+  QVERIFY(cmdline->reparse(arguments(QLatin1String("-l 1"))));
+  QCOMPARE(recorder->take(), QStringList());
+}
+
+void
+TestReparse::params()
+{
+  FILE *stream = tmpfile();
+
+  QVERIFY(stream);
+  fputs("x\ny\n", stream);
+  rewind(stream);
+  cmdline->setParamStream(stream);
+
+  /* '-' is not read, params are not reported */
+  QVERIFY(cmdline->reparse(arguments(QLatin1String("-l 1 dst -"))));
+  QCOMPARE(recorder->take(), QStringList());
+  QCOMPARE(ftell(stream), 0L);
+  fclose(stream);
+}
+
+QTEST_MAIN(TestReparse)
+#include "tst_reparse.moc"
@@ -0,0 +1,184 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * QCommandLineServer: requests sent over a local socket reach
+ * QCommandLine::reparse(), and a live server is never replaced.
+ */
+
+#include <QtTest/QtTest>
+#include <QtNetwork/QLocalServer>
+#include <QtNetwork/QLocalSocket>
+
+#ifdef Q_OS_UNIX
+# include <string.h>
+# include <sys/socket.h>
+# include <sys/un.h>
+# include <unistd.h>
+#endif
+
+#include "qcommandline.h"
+#include "qcommandlineserver.h"
+#include "testutils.h"
+
+/* Time given to the server to answer, in ms */
+static const int replyTimeout = 5000;
+
+class TestServer : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void init();
+  void cleanup();
+  void roundTrip();
+  void error();
+  void live();
+#ifdef Q_OS_UNIX
+  void stale();
+#endif
+
+private:
+  QByteArray request(const QByteArray & lines);
+
+  QString name;
+  QCommandLine *cmdline;
+  QCommandLineServer *server;
+};
+
+void
+TestServer::init()
+{
+  QCommandLineConfig config;
+  QCommandLineConfigEntry verbose = { QCommandLine::Switch, QLatin1Char('v'), QLatin1String("verbose"),
+				      QString(), QCommandLine::Optional };
+  QCommandLineConfigEntry level = { QCommandLine::Option, QLatin1Char('l'), QLatin1String("level"),
+				    QString(), QCommandLine::Optional };
+  QCommandLineConfigEntry target = { QCommandLine::Param, QChar(), QLatin1String("target"),
+				     QString(), QCommandLine::Mandatory };
+
+  config << verbose << level << target;
+  name = QDir::temp().absoluteFilePath(QString::fromLatin1("tst_server.%1")
+				       .arg(QCoreApplication::applicationPid()));
+  cmdline = new QCommandLine(arguments(QLatin1String("-l 1 dst")), config);
+  QVERIFY(cmdline->parse());
+
+  server = new QCommandLineServer(cmdline);
+  QVERIFY2(server->listen(name), qPrintable(server->errorString()));
+}
+
+void
+TestServer::cleanup()
+{
+  delete server;
+  delete cmdline;
+  QLocalServer::removeServer(name);
+}
+
+/* Send @p lines and wait for the one line reply */
+QByteArray
+TestServer::request(const QByteArray & lines)
+{
+  QLocalSocket client;
+  QTime timer;
+
+  client.connectToServer(name);
+  if (!client.waitForConnected(replyTimeout))
+    return QByteArray();
+
+  client.write(lines);
+  client.flush();
+
+  /* The server runs in this thread: let the event loop serve it */
+  timer.start();
+  while (!client.canReadLine() && timer.elapsed() < replyTimeout)
+    QTest::qWait(10);
+
+  return client.readLine();
+}
+
+void
+TestServer::roundTrip()
+{
+  QSignalSpy switches(cmdline, SIGNAL(switchFound(const QString &)));
+  QSignalSpy options(cmdline, SIGNAL(optionFound(const QString &, const QVariant &)));
+
+  QCOMPARE(request("--verbose\n--level=3\n\n"), QByteArray("ok\n"));
+  QCOMPARE(cmdline->arguments(), arguments(QLatin1String("--verbose --level=3")));
+  QCOMPARE(switches.count(), 1);
+  QCOMPARE(switches.at(0).at(0).toString(), QString::fromLatin1("verbose"));
+  QCOMPARE(options.count(), 1);
+  QCOMPARE(options.at(0).at(1).toString(), QString::fromLatin1("3"));
+
+  /* Nothing changed */
+  QCOMPARE(request("-l\n3\n-v\n\n"), QByteArray("ok\n"));
+  QCOMPARE(switches.count(), 1);
+  QCOMPARE(options.count(), 1);
+}
+
+void
+TestServer::error()
+{
+  QSignalSpy errors(cmdline, SIGNAL(parseError(const QString &)));
+
+  QCOMPARE(request("--bogus\n\n"), QByteArray("error: Unknown option: bogus\n"));
+  QCOMPARE(errors.count(), 1);
+  QCOMPARE(cmdline->arguments(), arguments(QLatin1String("-l 1 dst")));
+}
+
+void
+TestServer::live()
+{
+  QCommandLineServer other(cmdline);
+
+  QVERIFY(!other.listen(name));
+  QVERIFY(server->isListening());
+  QCOMPARE(request("-v\n\n"), QByteArray("ok\n"));
+}
+
+#ifdef Q_OS_UNIX
+void
+TestServer::stale()
+{
+  delete server;
+  server = 0;
+
+  /* A socket file nobody listens on, as left by a crashed instance */
+  QByteArray path = QFile::encodeName(name);
+  struct sockaddr_un addr;
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+  QVERIFY(fd != -1);
+  QVERIFY(path.size() < int(sizeof(addr.sun_path)));
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  memcpy(addr.sun_path, path.constData(), path.size());
+  QCOMPARE(bind(fd, (struct sockaddr *)&addr, sizeof(addr)), 0);
+  ::close(fd);
+  QVERIFY(QFile::exists(name));
+
+  server = new QCommandLineServer(cmdline);
+  QVERIFY2(server->listen(name), qPrintable(server->errorString()));
+  QCOMPARE(request("-v\n\n"), QByteArray("ok\n"));
+}
+#endif
+
+QTEST_MAIN(TestServer)
+#include "tst_server.moc"
@@ -0,0 +1,179 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * QCommandLineSession: classification of each argument, and updates
+ * reusing the classification of an unchanged prefix.
+ */
+
+#include <QtTest/QtTest>
+
+#include "qcommandlinesession.h"
+#include "testutils.h"
+
+class TestSession : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void classify_data();
+  void classify();
+  void updates_data();
+  void updates();
+  void configChange();
+  void paths();
+};
+
+/* Tokens as "S0 O1 V1 P2 E": kind initial, then id */
+static QString
+describe(const QVector< QCommandLineSession::Token > & tokens)
+{
+  static const char kinds[] = "SOVPE";
+  QStringList out;
+
+  foreach (const QCommandLineSession::Token & token, tokens) {
+    QString s(QLatin1Char(kinds[token.kind]));
+
+    if (token.kind != QCommandLineSession::Error)
+      s += QString::number(token.id);
+    out << s;
+  }
+  return out.join(QLatin1String(" "));
+}
+
+static void
+setup(QCommandLineCore & cmdline)
+{
+  cmdline.addSwitch(QLatin1Char('l'), QLatin1String("list"));
+  cmdline.addOption(QLatin1Char('o'), QLatin1String("output"));
+  cmdline.addParam(QLatin1String("target"));
+  cmdline.addParam(QLatin1String("source"), QString(), QCommandLineCore::OptionalMultiple);
+}
+
+/* What a new session gives for line */
+static QString
+classified(QCommandLineCore & cmdline, const QString & line)
+{
+  QCommandLineSession session(cmdline);
+
+  return describe(session.update(words(line)));
+}
+
+void
+TestSession::classify_data()
+{
+  QTest::addColumn< QString >("line");
+  QTest::addColumn< QString >("tokens");
+
+  QTest::newRow("all") << QString::fromLatin1("-l -o out a b c")
+		       << QString::fromLatin1("S0 O1 V1 P2 P3 P3");
+  QTest::newRow("long") << QString::fromLatin1("--output=x --list") << QString::fromLatin1("O1 S0");
+  QTest::newRow("stacked") << QString::fromLatin1("-lo x") << QString::fromLatin1("O1 V1");
+  QTest::newRow("unknown") << QString::fromLatin1("-z --bogus a") << QString::fromLatin1("E E P2");
+  /* An option value can't start with '-' */
+  QTest::newRow("dash value") << QString::fromLatin1("-o -l") << QString::fromLatin1("O1 E");
+  /* Its value would be the rest of the stacked switchs */
+  QTest::newRow("stacked value") << QString::fromLatin1("-ol") << QString::fromLatin1("E");
+}
+
+void
+TestSession::classify()
+{
+  QFETCH(QString, line);
+  QFETCH(QString, tokens);
+  QCommandLineCore cmdline;
+
+  setup(cmdline);
+  QCOMPARE(classified(cmdline, line), tokens);
+}
+
+void
+TestSession::updates_data()
+{
+  QTest::addColumn< bool >("lowMemory");
+
+  QTest::newRow("normal") << false;
+  /* A spec is built by every update, for the same configuration */
+  QTest::newRow("low memory") << true;
+}
+
+void
+TestSession::updates()
+{
+  QFETCH(bool, lowMemory);
+  QCommandLineCore cmdline;
+  QCommandLineSession session(cmdline);
+  QStringList lines;
+
+  setup(cmdline);
+  cmdline.enableLowMemory(lowMemory);
+
+  /* Typing, then editing the middle of the line */
+  lines << QLatin1String("-") << QLatin1String("-o") << QLatin1String("-o o")
+	<< QLatin1String("-o ou") << QLatin1String("-o out") << QLatin1String("-o out a")
+	<< QLatin1String("-o out a b") << QLatin1String("-l out a b")
+	<< QLatin1String("-l -o out a b") << QLatin1String("-l -o") << QString();
+
+  /* Each update gives what a new session gives */
+  foreach (const QString & line, lines) {
+    QCOMPARE(describe(session.update(words(line))), classified(cmdline, line));
+    QCOMPARE(describe(session.tokens()), classified(cmdline, line));
+  }
+}
+
+void
+TestSession::configChange()
+{
+  QCommandLineCore cmdline;
+  QCommandLineSession session(cmdline);
+
+  setup(cmdline);
+
+  /* Values are checked by validators */
+  cmdline.setValidator(QLatin1String("target"),
+		       QCommandLineValidator(QCommandLineValidator::Pattern, QLatin1String("[a-z]+")));
+  QCOMPARE(classified(cmdline, QLatin1String("A b")), QString::fromLatin1("E P3"));
+  QCOMPARE(classified(cmdline, QLatin1String("a B")), QString::fromLatin1("P2 P3"));
+
+  /* Everything is classified again after a configuration change */
+  QCOMPARE(describe(session.update(words(QLatin1String("a -v")))), QString::fromLatin1("P2 E"));
+  cmdline.addSwitch(QLatin1Char('v'), QLatin1String("verbose"));
+  QCOMPARE(describe(session.update(words(QLatin1String("a -v")))), QString::fromLatin1("P2 S4"));
+
+  /* And after a reset */
+  session.reset();
+  QVERIFY(session.tokens().isEmpty());
+  QCOMPARE(describe(session.update(words(QLatin1String("a -v")))), QString::fromLatin1("P2 S4"));
+}
+
+void
+TestSession::paths()
+{
+  QCommandLineCore cmdline;
+
+  setup(cmdline);
+
+  /* Left to parse(): a keystroke does not wait for the filesystem */
+  cmdline.setValidator(QLatin1String("target"), QCommandLineValidator(QCommandLineValidator::Exists));
+  QCOMPARE(classified(cmdline, QLatin1String("/nonexistent/target a")), QString::fromLatin1("P2 P3"));
+}
+
+QTEST_MAIN(TestSession)
+#include "tst_session.moc"
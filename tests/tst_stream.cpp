@@ -0,0 +1,134 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Stream params: records split on the separator, across the chunks
+ * they are read by, with or without a final separator.
+ */
+
+#include <QtTest/QtTest>
+#include <stdio.h>
+
+#include "qcommandlinecore.h"
+#include "testutils.h"
+
+/* Bytes read from the stream at once by the parser */
+static const int chunkSize = 64 * 1024;
+
+class TestStream : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void records_data();
+  void records();
+  void empty();
+};
+
+/* Parse "test -" with input as the stream, the files param being Multiple and Stream */
+static bool
+parseStream(const QByteArray & input, char separator, int flags, QCommandLineResult & result)
+{
+  QCommandLineCore cmdline;
+  FILE *stream = tmpfile();
+  bool ok;
+
+  if (!stream)
+    return false;
+  if (fwrite(input.constData(), 1, input.size(), stream) != size_t(input.size())) {
+    fclose(stream);
+    return false;
+  }
+  rewind(stream);
+
+  cmdline.addParam(QLatin1String("files"), QString(),
+		   QCommandLineCore::Flags(QCommandLineCore::Multiple | QCommandLineCore::Stream | flags));
+  cmdline.setParamStream(stream, separator);
+  ok = cmdline.parse(arguments(QLatin1String("-")), result);
+  fclose(stream);
+  return ok;
+}
+
+void
+TestStream::records_data()
+{
+  QByteArray full(chunkSize - 1, 'x');
+  QByteArray over(chunkSize, 'y');
+
+  QTest::addColumn< QByteArray >("input");
+  QTest::addColumn< int >("separator");
+  QTest::addColumn< QStringList >("records");
+
+  QTest::newRow("lines") << QByteArray("a\nb\nc\n") << int('\n')
+			 << (QStringList() << QLatin1String("a") << QLatin1String("b") << QLatin1String("c"));
+  QTest::newRow("no final separator") << QByteArray("a\nb") << int('\n')
+				      << (QStringList() << QLatin1String("a") << QLatin1String("b"));
+  QTest::newRow("empty records") << QByteArray("\n\na\n\n") << int('\n')
+				 << (QStringList() << QLatin1String("a"));
+  /* find -print0: newlines and spaces are part of the names */
+  QTest::newRow("print0") << QByteArray("a b\0c\nd\0", 8) << int('\0')
+			  << (QStringList() << QLatin1String("a b") << QLatin1String("c\nd"));
+  QTest::newRow("print0 no final separator") << QByteArray("a\0b", 3) << int('\0')
+					     << (QStringList() << QLatin1String("a") << QLatin1String("b"));
+
+  /* The separator is the last byte of the first chunk */
+  QTest::newRow("separator ends a chunk") << full + "\nb\n" << int('\n')
+					  << (QStringList() << QString::fromLatin1(full.constData()) << QLatin1String("b"));
+  /* The separator is the first byte of the second chunk */
+  QTest::newRow("separator starts a chunk") << over + "\nb\n" << int('\n')
+					    << (QStringList() << QString::fromLatin1(over.constData()) << QLatin1String("b"));
+  /* A record split between two chunks */
+  QTest::newRow("record across chunks") << "a\n" + over + "\n" << int('\n')
+					<< (QStringList() << QLatin1String("a") << QString::fromLatin1(over.constData()));
+  /* Exactly one chunk, then nothing left to read */
+  QTest::newRow("one full chunk") << full + "\n" << int('\n')
+				  << (QStringList() << QString::fromLatin1(full.constData()));
+  QTest::newRow("one full chunk no final separator") << over << int('\n')
+						     << (QStringList() << QString::fromLatin1(over.constData()));
+}
+
+void
+TestStream::records()
+{
+  QFETCH(QByteArray, input);
+  QFETCH(int, separator);
+  QFETCH(QStringList, records);
+  QCommandLineResult result;
+
+  QVERIFY(parseStream(input, char(separator), QCommandLineCore::Optional, result));
+  QCOMPARE(result.values(QLatin1String("files")).size(), records.size());
+  QCOMPARE(result.values(QLatin1String("files")), records);
+}
+
+void
+TestStream::empty()
+{
+  QCommandLineResult optional, mandatory;
+
+  QVERIFY(parseStream(QByteArray(), '\n', QCommandLineCore::Optional, optional));
+  QVERIFY(optional.values(QLatin1String("files")).isEmpty());
+
+  /* Nothing read: a Mandatory param is missing */
+  QVERIFY(!parseStream(QByteArray("\n\n"), '\n', QCommandLineCore::Mandatory, mandatory));
+  QCOMPARE(mandatory.errorString(), QString::fromLatin1("Param files is mandatory"));
+}
+
+QTEST_MAIN(TestStream)
+#include "tst_stream.moc"
@@ -0,0 +1,192 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Threads parsing while the configuration changes: each parse must see
+ * one configuration or the other, never a half updated spec. Build with
+ * -DQCOMMANDLINE_SANITIZE_THREAD=ON to run it under ThreadSanitizer.
+ */
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QSet>
+#include <QtCore/QThread>
+#include <QtTest/QtTest>
+
+#include "qcommandlinecore.h"
+#include "testutils.h"
+
+static const int updates = 2000;
+
+/* Parses args until stopped, counting the results that are not in outcomes */
+class StressThread : public QThread
+{
+public:
+  StressThread(QCommandLineCore *cmdline, const QStringList & args, const QSet< QString > & outcomes,
+	       QAtomicInt *stop, QAtomicInt *failures)
+    : parses(0), cmdline(cmdline), args(args), outcomes(outcomes), stop(stop), failures(failures)
+  {
+  }
+
+  int parses; /* read once the thread is finished */
+
+protected:
+  void run()
+  {
+    while (!stop->fetchAndAddOrdered(0)) {
+      QCommandLineResult result;
+
+      cmdline->parse(args, result);
+      if (!outcomes.contains(eventLines(result).join(QLatin1String("\n"))))
+	failures->ref();
+      parses++;
+    }
+  }
+
+private:
+  QCommandLineCore *cmdline;
+  QStringList args;
+  QSet< QString > outcomes;
+  QAtomicInt *stop;
+  QAtomicInt *failures;
+};
+
+/* Runs parsers on args while update() is called updates times */
+class Stress
+{
+public:
+  Stress(QCommandLineCore & cmdline, const QString & line)
+    : cmdline(cmdline), args(arguments(line)), stop(0), failures(0)
+  {
+  }
+
+  void outcome(const QStringList & events)
+  {
+    outcomes << events.join(QLatin1String("\n"));
+  }
+
+  void start()
+  {
+    int count = qMax(4, QThread::idealThreadCount());
+
+    for (int i = 0; i < count; i++) {
+      threads << new StressThread(&cmdline, args, outcomes, &stop, &failures);
+      threads.last()->start();
+    }
+  }
+
+  /* Stops the parsers, returns how many results were unexpected */
+  int finish()
+  {
+    int parses = 0;
+
+    stop.fetchAndStoreOrdered(1);
+    foreach (StressThread *thread, threads) {
+      thread->wait();
+      parses += thread->parses;
+      delete thread;
+    }
+    threads.clear();
+    return parses ? int(failures) : -1;
+  }
+
+private:
+  QCommandLineCore & cmdline;
+  QStringList args;
+  QSet< QString > outcomes;
+  QList< StressThread * > threads;
+  QAtomicInt stop;
+  QAtomicInt failures;
+};
+
+class TestStress : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void addRemove();
+  void patterns();
+};
+
+void
+TestStress::addRemove()
+{
+  QCommandLineCore cmdline;
+  Stress stress(cmdline, QLatin1String("-v --extra=1 a b"));
+
+  cmdline.addSwitch(QLatin1Char('v'), QLatin1String("verbose"));
+  cmdline.addParam(QLatin1String("file"), QString(), QCommandLineCore::OptionalMultiple);
+
+  /* Params are reported while parsing, switchs and options at the end */
+  stress.outcome(QStringList()
+		 << eventLine(QCommandLineEvent::Param, QLatin1String("file"), QLatin1String("a"))
+		 << eventLine(QCommandLineEvent::Param, QLatin1String("file"), QLatin1String("b"))
+		 << eventLine(QCommandLineEvent::Switch, QLatin1String("verbose"), QString())
+		 << eventLine(QCommandLineEvent::Option, QLatin1String("extra"), QLatin1String("1")));
+  stress.outcome(QStringList()
+		 << eventLine(QCommandLineEvent::Error, QString(), QLatin1String("Unknown option: extra")));
+  stress.start();
+
+  /* Options added and removed, and entries the parsers never see */
+  for (int i = 0; i < updates; i++) {
+    cmdline.addOption(QLatin1Char('x'), QLatin1String("extra"));
+    cmdline.addSwitch(QLatin1Char('q'), QLatin1String("quiet"));
+    cmdline.removeOption(QLatin1String("extra"));
+    cmdline.removeSwitch(QLatin1String("quiet"));
+  }
+  cmdline.addOption(QLatin1Char('x'), QLatin1String("extra"));
+
+  QCOMPARE(stress.finish(), 0);
+
+  /* The last published spec is still in use */
+  QCommandLineResult result;
+
+  QVERIFY(cmdline.parse(arguments(QLatin1String("--extra=2")), result));
+  QCOMPARE(result.values(QLatin1String("extra")), QStringList() << QLatin1String("2"));
+}
+
+void
+TestStress::patterns()
+{
+  QCommandLineCore cmdline;
+  Stress stress(cmdline, QLatin1String("a c"));
+  QCommandLineValidator letters(QCommandLineValidator::Pattern, QLatin1String("[a-c]"));
+  QCommandLineValidator ab(QCommandLineValidator::Pattern, QLatin1String("[ab]"));
+
+  cmdline.addParam(QLatin1String("file"), QString(), QCommandLineCore::OptionalMultiple);
+  cmdline.setValidator(QLatin1String("file"), letters);
+
+  /* Every parser matches the values with the QRegExp of the spec it uses */
+  stress.outcome(QStringList()
+		 << eventLine(QCommandLineEvent::Param, QLatin1String("file"), QLatin1String("a"))
+		 << eventLine(QCommandLineEvent::Param, QLatin1String("file"), QLatin1String("c")));
+  stress.outcome(QStringList()
+		 << eventLine(QCommandLineEvent::Param, QLatin1String("file"), QLatin1String("a"))
+		 << eventLine(QCommandLineEvent::Error, QString(),
+			      QLatin1String("Argument 2, file: 'c' does not match [ab]")));
+  stress.start();
+
+  for (int i = 0; i < updates; i++)
+    cmdline.setValidator(QLatin1String("file"), i % 2 ? letters : ab);
+
+  QCOMPARE(stress.finish(), 0);
+}
+
+QTEST_MAIN(TestStress)
+#include "tst_stress.moc"
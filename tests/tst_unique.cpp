@@ -0,0 +1,128 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Unique flag: a repeated value of a Multiple option or param is only
+ * reported where it first appeared.
+ */
+
+#include <QtTest/QtTest>
+
+#include "qcommandlinecore.h"
+#include "testutils.h"
+
+class TestUnique : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void values_data();
+  void values();
+  void perEntry();
+  void validated();
+};
+
+static void
+setup(QCommandLineCore & cmdline, int flags)
+{
+  cmdline.addOption(QLatin1Char('D'), QLatin1String("define"), QString(),
+		    QCommandLineCore::Flags(QCommandLineCore::Optional | flags));
+  cmdline.addParam(QLatin1String("files"), QString(),
+		   QCommandLineCore::Flags(QCommandLineCore::Optional | flags));
+}
+
+void
+TestUnique::values_data()
+{
+  QTest::addColumn< QString >("line");
+  QTest::addColumn< int >("flags");
+  QTest::addColumn< QString >("defines");
+  QTest::addColumn< QString >("files");
+
+  int unique = QCommandLineCore::Multiple | QCommandLineCore::Unique;
+
+  QTest::newRow("unique") << QString::fromLatin1("-D a -D b -D a -D c x y x z y") << unique
+			  << QString::fromLatin1("a b c") << QString::fromLatin1("x y z");
+  /* Short and long names are the same entry */
+  QTest::newRow("long name") << QString::fromLatin1("-D a --define=a --define=b -D b") << unique
+			     << QString::fromLatin1("a b") << QString();
+  QTest::newRow("case sensitive") << QString::fromLatin1("-D a -D A a A") << unique
+				  << QString::fromLatin1("a A") << QString::fromLatin1("a A");
+  QTest::newRow("multiple") << QString::fromLatin1("-D a -D b -D a x y x") << int(QCommandLineCore::Multiple)
+			    << QString::fromLatin1("a b a") << QString::fromLatin1("x y x");
+  /* Unique needs Multiple: the last value of the option is kept */
+  QTest::newRow("not multiple") << QString::fromLatin1("-D a -D b -D a x") << int(QCommandLineCore::Unique)
+				<< QString::fromLatin1("a") << QString::fromLatin1("x");
+}
+
+void
+TestUnique::values()
+{
+  QFETCH(QString, line);
+  QFETCH(int, flags);
+  QFETCH(QString, defines);
+  QFETCH(QString, files);
+  QCommandLineCore cmdline;
+  QCommandLineResult result;
+
+  setup(cmdline, flags);
+  QVERIFY2(cmdline.parse(arguments(line), result), qPrintable(result.errorString()));
+  QCOMPARE(result.values(QLatin1String("define")), words(defines));
+  QCOMPARE(result.values(QLatin1String("files")), words(files));
+}
+
+void
+TestUnique::perEntry()
+{
+  QCommandLineCore cmdline;
+  QCommandLineResult result;
+
+  setup(cmdline, QCommandLineCore::Multiple | QCommandLineCore::Unique);
+  cmdline.addOption(QLatin1Char('I'), QLatin1String("include"), QString(),
+		    QCommandLineCore::Flags(QCommandLineCore::OptionalMultiple | QCommandLineCore::Unique));
+
+  /* The same value given to two entries is kept for both */
+  QVERIFY(cmdline.parse(arguments(QLatin1String("-D a -I a -I a a")), result));
+  QCOMPARE(result.values(QLatin1String("define")), words(QLatin1String("a")));
+  QCOMPARE(result.values(QLatin1String("include")), words(QLatin1String("a")));
+  QCOMPARE(result.values(QLatin1String("files")), words(QLatin1String("a")));
+}
+
+void
+TestUnique::validated()
+{
+  QCommandLineCore cmdline;
+  QCommandLineResult result, invalid;
+
+  setup(cmdline, QCommandLineCore::Multiple | QCommandLineCore::Unique);
+  cmdline.setValidator(QLatin1String("define"),
+		       QCommandLineValidator(QCommandLineValidator::Pattern, QLatin1String("[a-z]")));
+
+  /* Dropped duplicates are not reported nor checked again */
+  QVERIFY(cmdline.parse(arguments(QLatin1String("-D a -D a -D b")), result));
+  QCOMPARE(result.values(QLatin1String("define")), words(QLatin1String("a b")));
+
+  /* The index of an invalid value is the one of its first occurrence */
+  QVERIFY(!cmdline.parse(arguments(QLatin1String("-D a -D 1 -D 1")), invalid));
+  QCOMPARE(invalid.errorString(), QString::fromLatin1("Argument 4, define: '1' does not match [a-z]"));
+}
+
+QTEST_MAIN(TestUnique)
+#include "tst_unique.moc"
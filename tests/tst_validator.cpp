@@ -0,0 +1,175 @@
+/* This file is part of QCommandLine
+ *
+ * Copyright (C) 2010-2011 Corentin Chary <corentin.chary@gmail.com>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public License
+ * along with this library; see the file COPYING.LIB.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Validators: which value is reported, with which argument index, and
+ * that values before an invalid one are still reported in order.
+ */
+
+#include <QtCore/QTemporaryFile>
+#include <QtTest/QtTest>
+
+#include "qcommandlinecore.h"
+#include "testutils.h"
+
+class TestValidator : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void number_data();
+  void number();
+  void pattern();
+  void invalidPattern();
+  void paths();
+  void pathsOrder();
+};
+
+void
+TestValidator::number_data()
+{
+  QTest::addColumn< QString >("line");
+  QTest::addColumn< QStringList >("values");
+  QTest::addColumn< QString >("error");
+
+  QTest::newRow("valid") << QString::fromLatin1("--level=3")
+			 << (QStringList() << QLatin1String("3")) << QString();
+  QTest::newRow("joined") << QString::fromLatin1("--level=9") << QStringList()
+			  << QString::fromLatin1("Argument 1, level: '9' is not a number between 1 and 5");
+  /* The index is the one of the value, not of the option */
+  QTest::newRow("separate") << QString::fromLatin1("-l x") << QStringList()
+			    << QString::fromLatin1("Argument 2, level: 'x' is not a number between 1 and 5");
+}
+
+void
+TestValidator::number()
+{
+  QFETCH(QString, line);
+  QFETCH(QStringList, values);
+  QFETCH(QString, error);
+  QCommandLineCore cmdline;
+  QCommandLineResult result;
+
+  cmdline.addOption(QLatin1Char('l'), QLatin1String("level"));
+  cmdline.setValidator(QLatin1String("level"),
+		       QCommandLineValidator(QCommandLineValidator::Number, QString(), 1, 5));
+
+  QCOMPARE(cmdline.parse(arguments(line), result), error.isEmpty());
+  QCOMPARE(result.values(QLatin1String("level")), values);
+  QCOMPARE(result.errorString(), error);
+}
+
+void
+TestValidator::pattern()
+{
+  QCommandLineCore cmdline;
+  QCommandLineResult result;
+
+  cmdline.addParam(QLatin1String("name"), QString(), QCommandLineCore::OptionalMultiple);
+  cmdline.setValidator(QLatin1String("name"),
+		       QCommandLineValidator(QCommandLineValidator::Pattern, QLatin1String("[a-z]+")));
+
+  /* A value containing %1 must not be replaced by the pattern */
+  QVERIFY(!cmdline.parse(arguments(QLatin1String("abc %1x def")), result));
+  QCOMPARE(eventLines(result), QStringList()
+	   << eventLine(QCommandLineEvent::Param, QLatin1String("name"), QLatin1String("abc"))
+	   << eventLine(QCommandLineEvent::Error, QString(),
+			QLatin1String("Argument 2, name: '%1x' does not match [a-z]+")));
+}
+
+void
+TestValidator::invalidPattern()
+{
+  QCommandLineCore cmdline;
+  QCommandLineResult result;
+
+  cmdline.addParam(QLatin1String("name"));
+  cmdline.setValidator(QLatin1String("name"),
+		       QCommandLineValidator(QCommandLineValidator::Pattern, QLatin1String("[a-z]+")));
+
+  /* Ignored with a warning, the previous validator stays */
+  cmdline.setValidator(QLatin1String("name"),
+		       QCommandLineValidator(QCommandLineValidator::Pattern, QLatin1String("[a-")));
+  QVERIFY(cmdline.parse(arguments(QLatin1String("abc")), result));
+  QVERIFY(!cmdline.parse(arguments(QLatin1String("ABC")), result));
+  QCOMPARE(result.errorString(), QString::fromLatin1("Argument 1, name: 'ABC' does not match [a-z]+"));
+}
+
+void
+TestValidator::paths()
+{
+  QTemporaryFile file;
+
+  QVERIFY(file.open());
+
+  QString exists = file.fileName();
+  QString missing = exists + QLatin1String(".missing");
+  QCommandLineCore cmdline;
+  QCommandLineResult result;
+
+  cmdline.addParam(QLatin1String("input"), QString(), QCommandLineCore::OptionalMultiple);
+  cmdline.setValidator(QLatin1String("input"), QCommandLineValidator(QCommandLineValidator::File));
+
+  /* Values before the first invalid one are reported, in order, then only that one */
+  QVERIFY(!cmdline.parse(QStringList() << QLatin1String("test") << exists << exists << missing
+			 << missing + QLatin1String("2"), result));
+  QCOMPARE(eventLines(result), QStringList()
+	   << eventLine(QCommandLineEvent::Param, QLatin1String("input"), exists)
+	   << eventLine(QCommandLineEvent::Param, QLatin1String("input"), exists)
+	   << eventLine(QCommandLineEvent::Error, QString(),
+			QLatin1String("Argument 3, input: '") + missing + QLatin1String("' does not exist")));
+}
+
+void
+TestValidator::pathsOrder()
+{
+  QTemporaryFile file;
+
+  QVERIFY(file.open());
+
+  QString missing = file.fileName() + QLatin1String(".missing");
+  QCommandLineCore cmdline;
+
+  cmdline.addParam(QLatin1String("name"));
+  cmdline.setValidator(QLatin1String("name"),
+		       QCommandLineValidator(QCommandLineValidator::Pattern, QLatin1String("[a-z]+")));
+  cmdline.addParam(QLatin1String("input"));
+  cmdline.setValidator(QLatin1String("input"), QCommandLineValidator(QCommandLineValidator::File));
+
+  /* An invalid value is reported before a later queued invalid path */
+  QCommandLineResult order;
+
+  QVERIFY(!cmdline.parse(QStringList() << QLatin1String("test") << QLatin1String("ABC") << missing,
+			 order));
+  QCOMPARE(order.errorString(), QString::fromLatin1("Argument 1, name: 'ABC' does not match [a-z]+"));
+
+  /* And a queued invalid path before a later invalid value */
+  QCommandLineResult first;
+
+  cmdline.removeParam(QLatin1String("name"));
+  cmdline.addParam(QLatin1String("name"));
+  QVERIFY(!cmdline.parse(QStringList() << QLatin1String("test") << missing << QLatin1String("ABC"),
+			 first));
+  QCOMPARE(first.errorString(),
+	   QLatin1String("Argument 1, input: '") + missing + QLatin1String("' does not exist"));
+}
+
+QTEST_MAIN(TestValidator)
+#include "tst_validator.moc"